@@ -0,0 +1,134 @@
+#include "benchmark.hh"
+#include "objectpool.hh"
+#include "person.hh"
+#include "careperiod.hh"
+#include "smallset.hh"
+#include <set>
+#include <vector>
+
+// Care periods created for every patient, and staff members assigned to
+// every care period.
+const unsigned int PERIODS_PER_PATIENT = 3;
+const unsigned int STAFF_PER_PERIOD = 3;
+
+// Allocates every object separately with new and deletes them one at
+// a time, as Hospital did before object pools.
+static void allocate_separately(const std::vector<Handle>& names)
+{
+    benchmark::Timer timer;
+    std::vector<Person*> persons;
+    std::vector<CarePeriod*> care_periods;
+    for ( Handle name : names )
+    {
+        Person* person = new Person(name);
+        persons.push_back(person);
+        for ( unsigned int i = 0; i < PERIODS_PER_PATIENT; ++i )
+        {
+            care_periods.push_back(new CarePeriod(Date(1, 1, 2021), person,
+                                                  care_periods.size()));
+        }
+    }
+    double created = timer.elapsed_ms();
+    benchmark::Timer teardown;
+    for ( Person* person : persons )
+    {
+        delete person;
+    }
+    for ( CarePeriod* care_period : care_periods )
+    {
+        delete care_period;
+    }
+    benchmark::report("allocation_create", "new", names.size(), created);
+    benchmark::report("allocation_teardown", "new", names.size(),
+                      teardown.elapsed_ms());
+}
+
+// Allocates the same objects from object pools.
+static void allocate_from_pool(const std::vector<Handle>& names)
+{
+    benchmark::Timer timer;
+    ObjectPool<Person>* persons = new ObjectPool<Person>();
+    ObjectPool<CarePeriod>* care_periods = new ObjectPool<CarePeriod>();
+    for ( Handle name : names )
+    {
+        Person* person = persons->create(name);
+        for ( unsigned int i = 0; i < PERIODS_PER_PATIENT; ++i )
+        {
+            care_periods->create(Date(1, 1, 2021), person,
+                                 care_periods->size());
+        }
+    }
+    double created = timer.elapsed_ms();
+    benchmark::Timer teardown;
+    delete persons;
+    delete care_periods;
+    benchmark::report("allocation_create", "pool", names.size(), created);
+    benchmark::report("allocation_teardown", "pool", names.size(),
+                      teardown.elapsed_ms());
+}
+
+// Returns true if the staff member is in the set.
+static bool contains(const std::set<Handle>& staff, Handle staff_member)
+{
+    return staff.find(staff_member) != staff.end();
+}
+
+static bool contains(const SmallSet<Handle, 4>& staff, Handle staff_member)
+{
+    return staff.contains(staff_member);
+}
+
+// Fills a staff set for every care period, finds every staff member in
+// them and then destroys the sets.
+template <typename Set>
+static void fill_staff_sets(const std::string& variant,
+                            const std::vector<Handle>& names)
+{
+    unsigned long periods = names.size() * PERIODS_PER_PATIENT;
+    benchmark::Timer timer;
+    std::vector<Set>* sets = new std::vector<Set>(periods);
+    for ( unsigned long i = 0; i < periods; ++i )
+    {
+        for ( unsigned int j = 0; j < STAFF_PER_PERIOD; ++j )
+        {
+            sets->at(i).insert((i * 7 + j * 13) % 1000);
+        }
+    }
+    benchmark::report("staff_set_create", variant, names.size(),
+                      timer.elapsed_ms());
+
+    // Number of staff members found keeps the compiler from dropping
+    // the lookups.
+    volatile unsigned long found = 0;
+    benchmark::Timer finding;
+    for ( unsigned long i = 0; i < periods; ++i )
+    {
+        for ( unsigned int j = 0; j < STAFF_PER_PERIOD * 2; ++j )
+        {
+            if ( contains(sets->at(i), (i * 7 + j * 13) % 1000) )
+            {
+                found = found + 1;
+            }
+        }
+    }
+    benchmark::report("staff_set_find", variant, names.size(),
+                      finding.elapsed_ms());
+
+    benchmark::Timer teardown;
+    delete sets;
+    benchmark::report("staff_set_teardown", variant, names.size(),
+                      teardown.elapsed_ms());
+}
+
+void benchmark::allocation(unsigned long patients)
+{
+    std::vector<Handle> names;
+    for ( unsigned long i = 0; i < patients; ++i )
+    {
+        names.push_back(i);
+    }
+    allocate_separately(names);
+    allocate_from_pool(names);
+    fill_staff_sets<std::set<Handle>>("set", names);
+    fill_staff_sets<SmallSet<Handle, 4>>("small", names);
+}
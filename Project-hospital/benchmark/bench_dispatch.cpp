@@ -0,0 +1,81 @@
+#include "benchmark.hh"
+#include "cli.hh"
+#include <random>
+#include <string>
+#include <vector>
+
+// Command tokens of a typical admission log and how often they appear.
+struct Token
+{
+    std::string text;
+    unsigned int weight;
+};
+const std::vector<Token> COMMAND_MIX =
+{
+    {"e", 30}, {"l", 25}, {"as", 20}, {"am", 10}, {"rm", 5}, {"ad", 4},
+    {"ENTER", 2}, {"Leave", 1}, {"ppi", 1}, {"pcps", 1}, {"r", 1}
+};
+
+// Finds a command by comparing the upper case token with every alias,
+// as Cli did before the alias map.
+static const Cmd* find_linearly(const std::vector<Cmd>& commands,
+                                const std::string& cmd)
+{
+    std::string upper_cmd = cmd;
+    for ( unsigned int i = 0; i < cmd.size(); ++i )
+    {
+        upper_cmd.at(i) = std::toupper(cmd.at(i));
+    }
+    for ( const Cmd& command : commands )
+    {
+        for ( const std::string& alias : command.aliases )
+        {
+            if ( alias == upper_cmd )
+            {
+                return &command;
+            }
+        }
+    }
+    return nullptr;
+}
+
+void benchmark::dispatch(unsigned long lookups)
+{
+    std::vector<std::string> tokens;
+    for ( const Token& token : COMMAND_MIX )
+    {
+        tokens.insert(tokens.end(), token.weight, token.text);
+    }
+    std::mt19937 generator(1);
+    std::uniform_int_distribution<unsigned int> pick(0, tokens.size() - 1);
+    std::vector<const std::string*> input;
+    for ( unsigned long i = 0; i < lookups; ++i )
+    {
+        input.push_back(&tokens.at(pick(generator)));
+    }
+
+    Hospital hospital;
+    Cli cli(&hospital, "");
+    // Sum of found pointers keeps the compiler from dropping the lookups.
+    unsigned long found = 0;
+
+    Timer linear;
+    for ( const std::string* token : input )
+    {
+        found += reinterpret_cast<unsigned long>(
+                    find_linearly(cli.get_commands(), *token));
+    }
+    report("dispatch", "linear", lookups, linear.elapsed_ms());
+
+    Timer hashed;
+    for ( const std::string* token : input )
+    {
+        found -= reinterpret_cast<unsigned long>(cli.find_command(*token));
+    }
+    report("dispatch", "hash", lookups, hashed.elapsed_ms());
+
+    if ( found != 0 )
+    {
+        report("dispatch", "mismatch", found, 0);
+    }
+}
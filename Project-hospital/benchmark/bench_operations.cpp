@@ -0,0 +1,138 @@
+#include "benchmark.hh"
+#include "workload.hh"
+#include "cli.hh"
+#include "utils.hh"
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+// Number of single patient and staff member reports timed.
+const unsigned int PATIENT_REPORTS = 1000;
+const unsigned int STAFF_REPORTS = 100;
+
+// Directory where the export benchmark writes its files.
+const std::string EXPORT_DIRECTORY = "benchmark_export";
+
+// Runs the commands and adds the time of each command to the total of
+// its long alias.
+static void run_commands(Cli& cli, Hospital& hospital,
+                         std::vector<std::string>& commands,
+                         std::map<std::string, double>& totals,
+                         std::string& output)
+{
+    std::vector<std::string_view> params;
+    std::string_view cmd;
+    for ( std::string& line : commands )
+    {
+        char* cursor = &line[0];
+        utils::next_token(cursor, cursor + line.size(), ' ', cmd);
+        utils::split(cursor, &line[0] + line.size(), ' ', params);
+        Cmd* command = cli.find_command(cmd);
+        if ( command == nullptr or command->func_ptr == nullptr )
+        {
+            continue;
+        }
+        benchmark::Timer timer;
+        (hospital.*(command->func_ptr))(params);
+        hospital.output().flush();
+        totals[command->aliases.front()] += timer.elapsed_ms();
+        output.clear();
+    }
+}
+
+// Times the given command run once with the given parameters.
+static void time_report(Cli& cli, Hospital& hospital, const std::string& cmd,
+                        const std::vector<std::string_view>& params,
+                        unsigned long size, std::string& output)
+{
+    Cmd* command = cli.find_command(cmd);
+    benchmark::Timer timer;
+    (hospital.*(command->func_ptr))(params);
+    hospital.output().flush();
+    benchmark::report("report", command->aliases.front(), size,
+                      timer.elapsed_ms());
+    output.clear();
+}
+
+// Times the given command run once for each of the given names.
+static void time_reports(Cli& cli, Hospital& hospital, const std::string& cmd,
+                         const std::vector<std::string>& names,
+                         unsigned long size, std::string& output)
+{
+    Cmd* command = cli.find_command(cmd);
+    std::vector<std::string_view> params(1);
+    benchmark::Timer timer;
+    for ( const std::string& name : names )
+    {
+        params.at(0) = name;
+        (hospital.*(command->func_ptr))(params);
+        hospital.output().flush();
+        output.clear();
+    }
+    benchmark::report("report", command->aliases.front(), size,
+                      timer.elapsed_ms());
+}
+
+// Builds a hospital of the given size, timing every operation, and then
+// times the print commands.
+static void run_workload(unsigned long patients)
+{
+    benchmark::WorkloadSettings settings =
+            benchmark::default_settings(patients);
+    std::vector<std::string> commands;
+    benchmark::generate_workload(settings, commands);
+
+    // Output is formatted into a string, so that formatting is timed but
+    // writing to the terminal is not.
+    Hospital hospital;
+    Cli cli(&hospital, "");
+    std::string output;
+    hospital.output().set_string(&output);
+
+    std::map<std::string, double> totals;
+    run_commands(cli, hospital, commands, totals, output);
+    for ( const std::pair<const std::string, double>& total : totals )
+    {
+        benchmark::report("operation", total.first, patients, total.second);
+    }
+
+    std::vector<std::string_view> none;
+    for ( const char* cmd : {"pap", "pcp", "pam", "pas", "los"} )
+    {
+        time_report(cli, hospital, cmd, none, patients, output);
+    }
+    std::string today = "24022021";
+    std::string later = "01012035";
+    time_report(cli, hospital, "ppo", {today}, patients, output);
+    time_report(cli, hospital, "ppb", {today, later}, patients, output);
+    time_report(cli, hospital, "c", {today, later}, patients, output);
+    time_report(cli, hospital, "su", {"10"}, patients, output);
+    time_report(cli, hospital, "ex", {EXPORT_DIRECTORY}, patients, output);
+
+    std::mt19937 random(settings.seed);
+    std::vector<std::string> names;
+    for ( unsigned int i = 0; i < PATIENT_REPORTS; ++i )
+    {
+        names.push_back("patient" + std::to_string(random() % patients));
+    }
+    time_reports(cli, hospital, "ppi", names, patients, output);
+    names.clear();
+    for ( unsigned int i = 0; i < STAFF_REPORTS; ++i )
+    {
+        names.push_back("staff" + std::to_string(random() % settings.staff));
+    }
+    time_reports(cli, hospital, "pcps", names, patients, output);
+    hospital.output().set_string(nullptr);
+}
+
+void benchmark::operations(unsigned long patients)
+{
+    for ( unsigned long size : {patients / 100, patients / 10, patients} )
+    {
+        if ( size > 0 )
+        {
+            run_workload(size);
+        }
+    }
+}
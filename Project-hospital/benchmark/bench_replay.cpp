@@ -0,0 +1,82 @@
+#include "benchmark.hh"
+#include "workload.hh"
+#include "cli.hh"
+#include "parallelreplay.hh"
+#include "utils.hh"
+#include <string>
+#include <thread>
+#include <vector>
+
+// Splits the commands into their names and parameters, which point into
+// the commands.
+static void parse_commands(Cli& cli, std::vector<std::string>& commands,
+                           std::vector<Cmd*>& funcs,
+                           std::vector<std::vector<std::string_view>>& params)
+{
+    std::string_view cmd;
+    for ( std::string& line : commands )
+    {
+        char* cursor = &line[0];
+        utils::next_token(cursor, cursor + line.size(), ' ', cmd);
+        params.emplace_back();
+        utils::split(cursor, &line[0] + line.size(), ' ', params.back());
+        funcs.push_back(cli.find_command(cmd));
+    }
+}
+
+// Runs the commands one by one.
+static void replay_serially(const std::vector<Cmd*>& funcs,
+                            const std::vector<std::vector<std::string_view>>&
+                            params, unsigned long size)
+{
+    Hospital hospital;
+    hospital.output().set_discard(true);
+    benchmark::Timer timer;
+    for ( unsigned long i = 0; i < funcs.size(); ++i )
+    {
+        (hospital.*(funcs.at(i)->func_ptr))(params.at(i));
+    }
+    benchmark::report("replay", "serial", size, timer.elapsed_ms());
+}
+
+// Replays the commands divided between the given number of shards.
+static void replay_in_shards(const std::vector<Cmd*>& funcs,
+                             const std::vector<std::vector<std::string_view>>&
+                             params, unsigned int shards, unsigned long size)
+{
+    Hospital hospital;
+    hospital.output().set_discard(true);
+    benchmark::Timer timer;
+    ParallelReplay replay(shards);
+    for ( unsigned long i = 0; i < funcs.size(); ++i )
+    {
+        replay.add(funcs.at(i)->func_ptr, params.at(i));
+    }
+    unsigned long errors = 0;
+    if ( not replay.run(hospital, errors) )
+    {
+        return;
+    }
+    benchmark::report("replay", "shards" + std::to_string(shards), size,
+                      timer.elapsed_ms());
+}
+
+void benchmark::replay(unsigned long patients)
+{
+    std::vector<std::string> commands;
+    benchmark::generate_workload(benchmark::default_settings(patients),
+                                 commands);
+    Hospital hospital;
+    Cli cli(&hospital, "");
+    std::vector<Cmd*> funcs;
+    std::vector<std::vector<std::string_view>> params;
+    parse_commands(cli, commands, funcs, params);
+
+    replay_serially(funcs, params, patients);
+    unsigned int threads = std::thread::hardware_concurrency();
+    for ( unsigned int shards = 1; shards <= threads or shards == 1;
+          shards *= 2 )
+    {
+        replay_in_shards(funcs, params, shards, patients);
+    }
+}
@@ -0,0 +1,123 @@
+#include "benchmark.hh"
+#include "symboltable.hh"
+#include <algorithm>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+// Handles of names in a red-black tree, as SymbolTable kept them before
+// the hash table.
+class MapTable
+{
+public:
+    using const_iterator =
+            std::map<std::string, Handle, std::less<>>::const_iterator;
+
+    Handle intern(std::string_view name)
+    {
+        std::map<std::string, Handle, std::less<>>::iterator iter =
+                handles_.lower_bound(name);
+        if ( iter == handles_.end() or iter->first != name )
+        {
+            iter = handles_.emplace_hint(iter, name, handles_.size());
+        }
+        return iter->second;
+    }
+
+    bool find(std::string_view name, Handle& handle) const
+    {
+        std::map<std::string, Handle, std::less<>>::const_iterator iter =
+                handles_.find(name);
+        if ( iter == handles_.end() )
+        {
+            return false;
+        }
+        handle = iter->second;
+        return true;
+    }
+
+    const_iterator begin() const
+    {
+        return handles_.begin();
+    }
+
+    const_iterator end() const
+    {
+        return handles_.end();
+    }
+
+private:
+    std::map<std::string, Handle, std::less<>> handles_;
+};
+
+// Interns the names, finds the given names and goes through all names in
+// alphabetical order, timing each phase.
+template <typename Table>
+static void run(const std::string& variant,
+                const std::vector<std::string>& names,
+                const std::vector<std::string>& lookups)
+{
+    Table* table = new Table();
+    benchmark::Timer interning;
+    for ( const std::string& name : names )
+    {
+        table->intern(name);
+    }
+    benchmark::report("names_intern", variant, names.size(),
+                      interning.elapsed_ms());
+
+    // Sum of the handles found keeps the compiler from dropping lookups.
+    volatile unsigned long sum = 0;
+    benchmark::Timer finding;
+    for ( const std::string& name : lookups )
+    {
+        Handle handle = 0;
+        if ( table->find(name, handle) )
+        {
+            sum += handle;
+        }
+    }
+    benchmark::report("names_find", variant, names.size(),
+                      finding.elapsed_ms());
+
+    benchmark::Timer iterating;
+    for ( typename Table::const_iterator iter = table->begin();
+          iter != table->end(); ++iter )
+    {
+        sum += iter->second;
+    }
+    benchmark::report("names_sorted", variant, names.size(),
+                      iterating.elapsed_ms());
+
+    benchmark::Timer teardown;
+    delete table;
+    benchmark::report("names_teardown", variant, names.size(),
+                      teardown.elapsed_ms());
+}
+
+void benchmark::symbol_table(unsigned long patients)
+{
+    std::mt19937 random(2021);
+    std::vector<std::string> names;
+    std::vector<std::string> lookups;
+    for ( unsigned long size : {patients, patients * 10, patients * 100} )
+    {
+        // Names are interned in random order, and nine lookups in ten
+        // find a name.
+        names.clear();
+        for ( unsigned long i = 0; i < size; ++i )
+        {
+            names.push_back("patient" + std::to_string(i));
+        }
+        std::shuffle(names.begin(), names.end(), random);
+        lookups.clear();
+        for ( unsigned long i = 0; i < size; ++i )
+        {
+            unsigned long number = random() % (size + size / 9 + 1);
+            lookups.push_back("patient" + std::to_string(number));
+        }
+        run<MapTable>("map", names, lookups);
+        run<SymbolTable>("hash", names, lookups);
+    }
+}
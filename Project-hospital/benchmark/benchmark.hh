@@ -0,0 +1,48 @@
+/* Module: Benchmark
+ * ----------
+ * COMP.CS.110 SPRING 2021
+ * ----------
+ * Common utilities of the hospital benchmarks. Every benchmark prints its
+ * results as comma separated lines:
+ * benchmark,variant,size,milliseconds
+ * */
+#ifndef BENCHMARK_HH
+#define BENCHMARK_HH
+
+#include <chrono>
+#include <string>
+
+namespace benchmark
+{
+/**
+ * @brief Timer
+ * Measures wall clock time from its creation.
+ */
+class Timer
+{
+public:
+    Timer();
+
+    // Returns milliseconds elapsed since creation.
+    double elapsed_ms() const;
+
+private:
+    std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * @brief report
+ * Prints a single result line.
+ */
+void report(const std::string& name, const std::string& variant,
+            unsigned long size, double milliseconds);
+
+// Benchmarks, each runs with the given size.
+void allocation(unsigned long patients);
+void dispatch(unsigned long lookups);
+void operations(unsigned long patients);
+void symbol_table(unsigned long patients);
+void replay(unsigned long patients);
+}
+
+#endif // BENCHMARK_HH
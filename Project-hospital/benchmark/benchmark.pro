@@ -0,0 +1,40 @@
+TEMPLATE = app
+CONFIG += console c++17 thread
+CONFIG -= app_bundle
+CONFIG -= qt
+
+INCLUDEPATH += ..
+
+SOURCES += \
+        main.cpp \
+    bench_allocation.cpp \
+    bench_dispatch.cpp \
+    bench_operations.cpp \
+    bench_symboltable.cpp \
+    bench_replay.cpp \
+    workload.cpp \
+    ../person.cpp \
+    ../date.cpp \
+    ../careperiod.cpp \
+    ../hospital.cpp \
+    ../cli.cpp \
+    ../utils.cpp \
+    ../symboltable.cpp \
+    ../reportwriter.cpp \
+    ../binaryio.cpp \
+    ../journal.cpp \
+    ../reportrunner.cpp \
+    ../intervalindex.cpp \
+    ../census.cpp \
+    ../latencyhistogram.cpp \
+    ../parallelreplay.cpp \
+    ../eventlog.cpp \
+    ../prescriptionlog.cpp \
+    ../tally.cpp
+
+HEADERS += \
+    benchmark.hh \
+    workload.hh \
+    ../objectpool.hh \
+    ../smallset.hh \
+    ../cli.hh
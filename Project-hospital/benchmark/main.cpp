@@ -0,0 +1,86 @@
+#include "benchmark.hh"
+#include "workload.hh"
+#include "utils.hh"
+#include <iostream>
+#include <string>
+#include <cstdlib>
+
+/* Hospital benchmarks
+ *
+ * Usage: benchmark [size]
+ * Runs all benchmarks with the given number of patients (default 100000)
+ * and prints the results as comma separated lines. Dispatch benchmark does
+ * ten lookups per patient. Operation and report benchmarks run generated
+ * workloads of 1 %, 10 % and 100 % of the size, and export the state into
+ * the directory benchmark_export. Name lookup benchmarks intern 1, 10 and
+ * 100 times the size of names. Replay benchmark runs the workload of the
+ * size serially and divided between 1, 2, 4, ... shards.
+ *
+ * Usage: benchmark --generate {file} [size]
+ * Writes the generated workload of the given number of patients into the
+ * file, to be run in the hospital program with the command batch.
+*/
+const std::string GENERATE = "--generate";
+
+benchmark::Timer::Timer():
+    start_(std::chrono::steady_clock::now())
+{
+}
+
+double benchmark::Timer::elapsed_ms() const
+{
+    std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start_;
+    return elapsed.count();
+}
+
+void benchmark::report(const std::string& name, const std::string& variant,
+                       unsigned long size, double milliseconds)
+{
+    std::cout << name << "," << variant << "," << size << ","
+              << milliseconds << std::endl;
+}
+
+// Writes a workload file ending with the quit command.
+static int generate(const std::string& filename, unsigned long size)
+{
+    std::vector<std::string> commands;
+    benchmark::generate_workload(benchmark::default_settings(size), commands);
+    std::string contents;
+    for ( const std::string& command : commands )
+    {
+        contents += command;
+        contents += '\n';
+    }
+    contents += "q\n";
+    if ( not utils::write_file(filename, contents) )
+    {
+        std::cerr << "Error: Can't write file: " << filename << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned long size = 100000;
+    if ( argc > 2 and argv[1] == GENERATE )
+    {
+        if ( argc > 3 )
+        {
+            size = std::strtoul(argv[3], nullptr, 10);
+        }
+        return generate(argv[2], size);
+    }
+    if ( argc > 1 )
+    {
+        size = std::strtoul(argv[1], nullptr, 10);
+    }
+    std::cout << "benchmark,variant,size,milliseconds" << std::endl;
+    benchmark::allocation(size);
+    benchmark::dispatch(size * 10);
+    benchmark::operations(size);
+    benchmark::symbol_table(size);
+    benchmark::replay(size);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,154 @@
+#include "workload.hh"
+#include <random>
+
+// Relative weights of the commands after all staff has been recruited.
+const unsigned int ENTER_NEW_WEIGHT = 20;
+const unsigned int RE_ENTER_WEIGHT = 6;
+const unsigned int LEAVE_WEIGHT = 24;
+const unsigned int ASSIGN_STAFF_WEIGHT = 25;
+const unsigned int ADD_MEDICINE_WEIGHT = 18;
+const unsigned int REMOVE_MEDICINE_WEIGHT = 6;
+const unsigned int ADVANCE_DATE_WEIGHT = 1;
+
+// Patients in the hospital at most before new ones wait for others
+// leaving, and the largest strength and dosage of medicines.
+const unsigned long MAX_CURRENT_PATIENTS = 5000;
+const unsigned int MAX_STRENGTH = 1000;
+const unsigned int MAX_DOSAGE = 4;
+
+namespace
+{
+// Random choices of the generator.
+class Generator
+{
+public:
+    explicit Generator(unsigned int seed):
+        engine_(seed)
+    {
+    }
+
+    // Returns a random number from 0 to limit - 1.
+    unsigned long below(unsigned long limit)
+    {
+        return std::uniform_int_distribution<unsigned long>(0, limit - 1)(
+                    engine_);
+    }
+
+    // Removes a random element of the vector and returns it.
+    unsigned long take(std::vector<unsigned long>& values)
+    {
+        unsigned long i = below(values.size());
+        unsigned long value = values.at(i);
+        values.at(i) = values.back();
+        values.pop_back();
+        return value;
+    }
+
+private:
+    std::mt19937 engine_;
+};
+}
+
+benchmark::WorkloadSettings benchmark::default_settings(unsigned long patients)
+{
+    WorkloadSettings settings;
+    settings.patients = patients;
+    settings.staff = patients / 100 + 1;
+    settings.medicines = 500;
+    settings.seed = 2021;
+    return settings;
+}
+
+void benchmark::generate_workload(const WorkloadSettings& settings,
+                                  std::vector<std::string>& commands)
+{
+    Generator random(settings.seed);
+    commands.clear();
+    for ( unsigned long i = 0; i < settings.staff; ++i )
+    {
+        commands.push_back("r staff" + std::to_string(i));
+    }
+
+    // Patients in the hospital and those who have left it, and
+    // prescriptions that may still be in use as (medicine, patient).
+    std::vector<unsigned long> current;
+    std::vector<unsigned long> former;
+    std::vector<std::pair<unsigned long, unsigned long>> prescriptions;
+    unsigned long new_patients = 0;
+
+    // Upper limits of the random choice for each command.
+    const unsigned int enter_limit = ENTER_NEW_WEIGHT + RE_ENTER_WEIGHT;
+    const unsigned int leave_limit = enter_limit + LEAVE_WEIGHT;
+    const unsigned int assign_limit = leave_limit + ASSIGN_STAFF_WEIGHT;
+    const unsigned int add_limit = assign_limit + ADD_MEDICINE_WEIGHT;
+    const unsigned int remove_limit = add_limit + REMOVE_MEDICINE_WEIGHT;
+    const unsigned int total_weight = remove_limit + ADVANCE_DATE_WEIGHT;
+    while ( new_patients < settings.patients )
+    {
+        unsigned long choice = random.below(total_weight);
+
+        // A full hospital makes patients leave instead of entering.
+        if ( choice < enter_limit and current.size() < MAX_CURRENT_PATIENTS )
+        {
+            unsigned long patient = new_patients;
+            if ( choice >= ENTER_NEW_WEIGHT and not former.empty() )
+            {
+                patient = random.take(former);
+            }
+            else
+            {
+                ++new_patients;
+            }
+            commands.push_back("e patient" + std::to_string(patient));
+            current.push_back(patient);
+            continue;
+        }
+        if ( current.empty() )
+        {
+            continue;
+        }
+
+        unsigned long patient = current.at(random.below(current.size()));
+        if ( choice < leave_limit )
+        {
+            unsigned long leaving = random.take(current);
+            commands.push_back("l patient" + std::to_string(leaving));
+            former.push_back(leaving);
+        }
+        else if ( choice < assign_limit )
+        {
+            commands.push_back("as staff" +
+                               std::to_string(random.below(settings.staff)) +
+                               " patient" + std::to_string(patient));
+        }
+        else if ( choice < add_limit )
+        {
+            unsigned long medicine = random.below(settings.medicines);
+            commands.push_back("am medicine" + std::to_string(medicine) +
+                               " " +
+                               std::to_string(random.below(MAX_STRENGTH) + 1) +
+                               " " +
+                               std::to_string(random.below(MAX_DOSAGE) + 1) +
+                               " patient" + std::to_string(patient));
+            prescriptions.push_back({medicine, patient});
+        }
+        else if ( choice < remove_limit )
+        {
+            if ( prescriptions.empty() )
+            {
+                continue;
+            }
+            unsigned long i = random.below(prescriptions.size());
+            commands.push_back("rm medicine" +
+                               std::to_string(prescriptions.at(i).first) +
+                               " patient" +
+                               std::to_string(prescriptions.at(i).second));
+            prescriptions.at(i) = prescriptions.back();
+            prescriptions.pop_back();
+        }
+        else
+        {
+            commands.push_back("ad 1");
+        }
+    }
+}
@@ -0,0 +1,51 @@
+/* Module: Workload
+ * ----------
+ * COMP.CS.110 SPRING 2021
+ * ----------
+ * Seeded generator of realistic command streams for the hospital. The
+ * same settings always give the same commands, so results of different
+ * versions of the program can be compared.
+ *
+ * All staff is recruited first. Then patients enter, leave and re-enter,
+ * get staff assigned and medicines added and removed, and the date is
+ * advanced now and then, until every patient has visited the hospital.
+ * */
+#ifndef WORKLOAD_HH
+#define WORKLOAD_HH
+
+#include <string>
+#include <vector>
+
+namespace benchmark
+{
+/**
+ * @brief WorkloadSettings
+ * Sizes of the workload and the seed of the random numbers.
+ */
+struct WorkloadSettings
+{
+    unsigned long patients;
+    unsigned long staff;
+    unsigned long medicines;
+    unsigned int seed;
+};
+
+/**
+ * @brief default_settings
+ * @param patients
+ * @return settings for the given number of patients, one staff member per
+ * hundred patients and a fixed set of medicines.
+ */
+WorkloadSettings default_settings(unsigned long patients);
+
+/**
+ * @brief generate_workload
+ * @param settings
+ * @param commands command lines, one command per line, without the final
+ * quit command.
+ */
+void generate_workload(const WorkloadSettings& settings,
+                       std::vector<std::string>& commands);
+}
+
+#endif // WORKLOAD_HH
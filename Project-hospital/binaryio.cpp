@@ -0,0 +1,247 @@
+#include "binaryio.hh"
+
+BinaryWriter::BinaryWriter(std::string& data):
+    data_(data)
+{
+}
+
+void BinaryWriter::write_u8(std::uint8_t value)
+{
+    data_.push_back(static_cast<char>(value));
+}
+
+void BinaryWriter::write_u32(std::uint32_t value)
+{
+    char bytes[4];
+    for ( unsigned int i = 0; i < 4; ++i )
+    {
+        bytes[i] = static_cast<char>(value >> (8 * i));
+    }
+    data_.append(bytes, 4);
+}
+
+void BinaryWriter::write_u64(std::uint64_t value)
+{
+    write_u32(static_cast<std::uint32_t>(value));
+    write_u32(static_cast<std::uint32_t>(value >> 32));
+}
+
+void BinaryWriter::write_string(const std::string& value)
+{
+    write_u32(value.size());
+    data_.append(value);
+}
+
+void BinaryWriter::write_bytes(const char* bytes, std::size_t size)
+{
+    data_.append(bytes, size);
+}
+
+void BinaryWriter::write_varint(std::uint32_t value)
+{
+    while ( value >= 0x80 )
+    {
+        data_.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    data_.push_back(static_cast<char>(value));
+}
+
+void BinaryWriter::patch_u32(std::size_t position, std::uint32_t value)
+{
+    for ( unsigned int i = 0; i < 4; ++i )
+    {
+        data_.at(position + i) = static_cast<char>(value >> (8 * i));
+    }
+}
+
+std::size_t BinaryWriter::size() const
+{
+    return data_.size();
+}
+
+BinaryReader::BinaryReader(const char* begin, const char* end):
+    current_(begin), end_(end), failed_(false)
+{
+}
+
+bool BinaryReader::read_u8(std::uint8_t& value)
+{
+    value = 0;
+    if ( not has_left(1) )
+    {
+        return false;
+    }
+    value = static_cast<unsigned char>(*current_++);
+    return true;
+}
+
+bool BinaryReader::read_u32(std::uint32_t& value)
+{
+    value = 0;
+    if ( not has_left(4) )
+    {
+        return false;
+    }
+    for ( unsigned int i = 0; i < 4; ++i )
+    {
+        value |= static_cast<std::uint32_t>(
+                    static_cast<unsigned char>(*current_++)) << (8 * i);
+    }
+    return true;
+}
+
+bool BinaryReader::read_u64(std::uint64_t& value)
+{
+    std::uint32_t low = 0;
+    std::uint32_t high = 0;
+    value = 0;
+    if ( not read_u32(low) or not read_u32(high) )
+    {
+        return false;
+    }
+    value = (static_cast<std::uint64_t>(high) << 32) | low;
+    return true;
+}
+
+bool BinaryReader::read_string(std::string& value)
+{
+    std::uint32_t size = 0;
+    value.clear();
+    return read_u32(size) and read_bytes(size, value);
+}
+
+bool BinaryReader::read_varint(std::uint32_t& value)
+{
+    value = 0;
+    for ( unsigned int shift = 0; shift < 35; shift += 7 )
+    {
+        std::uint8_t byte = 0;
+        if ( not read_u8(byte) )
+        {
+            value = 0;
+            return false;
+        }
+        // The last byte has room for the four highest bits only.
+        if ( shift == 28 and (byte & 0x70) != 0 )
+        {
+            break;
+        }
+        value |= static_cast<std::uint32_t>(byte & 0x7f) << shift;
+        if ( (byte & 0x80) == 0 )
+        {
+            return true;
+        }
+    }
+    // Too many bytes or bits for a 32 bit number.
+    failed_ = true;
+    value = 0;
+    return false;
+}
+
+bool BinaryReader::read_bytes(std::size_t size, std::string& value)
+{
+    value.clear();
+    if ( not has_left(size) )
+    {
+        return false;
+    }
+    value.assign(current_, size);
+    current_ += size;
+    return true;
+}
+
+bool BinaryReader::skip(std::size_t size)
+{
+    if ( not has_left(size) )
+    {
+        return false;
+    }
+    current_ += size;
+    return true;
+}
+
+bool BinaryReader::failed() const
+{
+    return failed_;
+}
+
+bool BinaryReader::at_end() const
+{
+    return current_ == end_;
+}
+
+const char* BinaryReader::position() const
+{
+    return current_;
+}
+
+bool BinaryReader::has_left(std::size_t size)
+{
+    if ( failed_ or static_cast<std::size_t>(end_ - current_) < size )
+    {
+        failed_ = true;
+        return false;
+    }
+    return true;
+}
+
+ColumnFile::ColumnFile()
+{
+}
+
+bool ColumnFile::open(const std::string& filename)
+{
+    buffer_.clear();
+    buffer_.reserve(BUFFER_SIZE);
+    file_.open(filename, std::ios::binary | std::ios::trunc);
+    return file_.is_open();
+}
+
+void ColumnFile::write_u32(std::uint32_t value)
+{
+    if ( buffer_.size() + 4 > BUFFER_SIZE )
+    {
+        flush();
+    }
+    BinaryWriter(buffer_).write_u32(value);
+}
+
+void ColumnFile::write_bytes(const char* bytes, std::size_t size)
+{
+    if ( buffer_.size() + size > BUFFER_SIZE )
+    {
+        flush();
+    }
+    // Bytes larger than the buffer are written as such.
+    if ( size > BUFFER_SIZE )
+    {
+        file_.write(bytes, size);
+        return;
+    }
+    buffer_.append(bytes, size);
+}
+
+bool ColumnFile::close()
+{
+    flush();
+    file_.close();
+    return not file_.fail();
+}
+
+void ColumnFile::flush()
+{
+    file_.write(buffer_.data(), buffer_.size());
+    buffer_.clear();
+}
+
+std::uint64_t binaryio::checksum(const char* begin, const char* end)
+{
+    std::uint64_t hash = 14695981039346656037ULL;
+    for ( const char* byte = begin; byte != end; ++byte )
+    {
+        hash ^= static_cast<unsigned char>(*byte);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
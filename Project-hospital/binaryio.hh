@@ -0,0 +1,120 @@
+/* Module: BinaryIO
+ * ----------
+ * COMP.CS.110 SPRING 2021
+ * ----------
+ * Classes for writing and reading compact binary data (snapshots, journals
+ * and exports of the hospital). Numbers are stored in little endian byte
+ * order and strings as their length followed by their characters.
+ * */
+#ifndef BINARYIO_HH
+#define BINARYIO_HH
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+class BinaryWriter
+{
+public:
+    // Constructor. Appends everything written to the given string.
+    BinaryWriter(std::string& data);
+
+    void write_u8(std::uint8_t value);
+    void write_u32(std::uint32_t value);
+    void write_u64(std::uint64_t value);
+    void write_string(const std::string& value);
+    void write_bytes(const char* bytes, std::size_t size);
+
+    // Writes a number in as few bytes as possible (7 bits per byte).
+    void write_varint(std::uint32_t value);
+
+    // Writes a 32 bit value at the given position of the data written
+    // earlier. Used for filling in sizes known only afterwards.
+    void patch_u32(std::size_t position, std::uint32_t value);
+
+    // Returns the number of bytes in the data.
+    std::size_t size() const;
+
+private:
+    std::string& data_;
+};
+
+class BinaryReader
+{
+public:
+    // Constructor. Reads the given bytes, which must stay alive as long as
+    // the reader is used.
+    BinaryReader(const char* begin, const char* end);
+
+    // Read methods return false and set the reader failed if there is not
+    // enough data left, or if a varint doesn't fit in 32 bits. Values of a
+    // failed reader are zero.
+    bool read_u8(std::uint8_t& value);
+    bool read_u32(std::uint32_t& value);
+    bool read_u64(std::uint64_t& value);
+    bool read_string(std::string& value);
+    bool read_varint(std::uint32_t& value);
+
+    // Reads the given number of bytes into the given string.
+    bool read_bytes(std::size_t size, std::string& value);
+
+    // Skips the given number of bytes.
+    bool skip(std::size_t size);
+
+    // Returns true if some read has failed.
+    bool failed() const;
+
+    // Returns true if all data has been read.
+    bool at_end() const;
+
+    // Returns the current read position.
+    const char* position() const;
+
+private:
+    const char* current_;
+    const char* end_;
+    bool failed_;
+
+    // Checks that the given number of bytes is left.
+    bool has_left(std::size_t size);
+};
+
+class ColumnFile
+{
+public:
+    // Constructor. Nothing is written before the file is opened.
+    ColumnFile();
+
+    // Creates or replaces the file. Returns false on failure.
+    bool open(const std::string& filename);
+
+    // Appends to the file through a buffer of fixed size, so writing
+    // allocates nothing once the file is open.
+    void write_u32(std::uint32_t value);
+    void write_bytes(const char* bytes, std::size_t size);
+
+    // Writes what is left in the buffer and closes the file. Returns false
+    // if the file could not be opened or some write failed.
+    bool close();
+
+private:
+    static const std::size_t BUFFER_SIZE = 1 << 16;
+
+    std::ofstream file_;
+    std::string buffer_;
+
+    // Writes the buffer into the file and empties it.
+    void flush();
+};
+
+namespace binaryio
+{
+/**
+ * @brief checksum
+ * @return 64 bit FNV-1a hash of the given bytes, used to detect damaged
+ * files.
+ */
+std::uint64_t checksum(const char* begin, const char* end);
+}
+
+#endif // BINARYIO_HH
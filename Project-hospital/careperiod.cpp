@@ -1,13 +1,16 @@
 #include "careperiod.hh"
-#include <iostream>
 
-CarePeriod::CarePeriod(const std::string& start, Person* patient):
-    patient_(patient), start_(start), end_(start), is_period_active_(true)
+CarePeriod::CarePeriod(const std::string& start, Person* patient,
+                       unsigned int number):
+    patient_(patient), start_(start), end_(start), number_(number),
+    is_period_active_(true)
 {
 }
 
-CarePeriod::CarePeriod(const Date &start, Person* patient):
-    patient_(patient), start_(start), end_(start), is_period_active_(true)
+CarePeriod::CarePeriod(const Date &start, Person* patient,
+                       unsigned int number):
+    patient_(patient), start_(start), end_(start), number_(number),
+    is_period_active_(true)
 {
 }
 
@@ -30,27 +33,46 @@ void CarePeriod::set_end_date(const Date& end)
     end_ = end;
 }
 
-void CarePeriod::add_staff(std::string staff_personnel)
+bool CarePeriod::add_staff(Handle staff_member)
 {
     // add staff into set.
-    staff_of_patient_.insert(staff_personnel);
+    return staff_of_patient_.insert(staff_member);
 }
 
-void CarePeriod::print_staff(const std::string& pretext)
+void CarePeriod::print_staff(ReportWriter& out, const std::string& pretext,
+                             const SymbolTable& staff_names)
 {
-    std::cout << pretext;
+    out << pretext;
     // No staff for patient. Print none.
-    if (staff_of_patient_.size() == 0)
+    if (staff_of_patient_.empty())
     {
-        std::cout << "None" << std::endl;
+        out << "None" << '\n';
         return;
     }
-    // Print all staff for a patient.
-    for (std::string staff_name : staff_of_patient_)
+    // Print all staff for a patient in alphabetical order.
+    std::vector<Handle> staff = get_staff();
+    staff_names.sort(staff);
+    for (Handle staff_member : staff)
     {
-        std::cout << staff_name << " ";
+        out << staff_names.name(staff_member) << " ";
     }
-    std::cout << std::endl;
+    out << '\n';
+}
+
+std::vector<Handle> CarePeriod::get_staff() const
+{
+    return std::vector<Handle>(staff_of_patient_.begin(),
+                               staff_of_patient_.end());
+}
+
+const Handle* CarePeriod::staff_begin() const
+{
+    return staff_of_patient_.begin();
+}
+
+const Handle* CarePeriod::staff_end() const
+{
+    return staff_of_patient_.end();
 }
 
 bool CarePeriod::is_it_active()
@@ -58,42 +80,39 @@ bool CarePeriod::is_it_active()
     return is_period_active_;
 }
 
-std::string CarePeriod::get_name()
+Handle CarePeriod::get_patient_id()
 {
     return patient_->get_id();
 }
 
+unsigned int CarePeriod::get_number() const
+{
+    return number_;
+}
+
 void CarePeriod::set_careperiod_inactive()
 {
     is_period_active_ = false;
 }
 
-bool CarePeriod::find_staff(std::string staff_to_find)
+bool CarePeriod::find_staff(Handle staff_member)
 {
-    // Loop through all staff
-    for (std::string staff_name : staff_of_patient_)
-    {
-        // Staff is found. return true
-        if (staff_name == staff_to_find)
-        {
-            return true;
-        }
-    }
-    return false;
+    return staff_of_patient_.contains(staff_member);
 }
 
-void CarePeriod::print_date_info(const std::string& pretext)
+void CarePeriod::print_date_info(ReportWriter& out,
+                                 const std::string& pretext)
 {
-    std::cout << pretext;
+    out << pretext;
     // Print date info like format wants.
-    get_start_date().print();
-    std::cout << " -";
+    get_start_date().print(out);
+    out << " -";
     if (!(is_it_active()) )
     {
-        std::cout << " ";
-        get_end_date().print();
+        out << " ";
+        get_end_date().print(out);
     }
-    std::cout << std::endl;
+    out << '\n';
 }
 
 
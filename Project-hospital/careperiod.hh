@@ -15,17 +15,21 @@
 
 #include "person.hh"
 #include "date.hh"
+#include "reportwriter.hh"
+#include "symboltable.hh"
+#include "smallset.hh"
 #include <string>
-#include <set>
+#include <vector>
 
 class CarePeriod
 {
 public:
     // Constructor, start date given as a string (ddmmyyyy).
-    CarePeriod(const std::string& start, Person* patient);
+    // Number tells the position of the care period in creation order.
+    CarePeriod(const std::string& start, Person* patient, unsigned int number);
 
     // Constructor, start date given as a Date object.
-    CarePeriod(const Date& start, Person* patient);
+    CarePeriod(const Date& start, Person* patient, unsigned int number);
 
     // Destructor.
     ~CarePeriod();
@@ -40,30 +44,44 @@ public:
     void set_end_date(const Date& end);
 
     // Method to add staff to patient's care period.
-    // Adds them in a set structure
-    void add_staff(std::string);
+    // Adds them in a sorted set. Returns false if staff member
+    // was already assigned to this care period.
+    bool add_staff(Handle staff_member);
 
     // Prints all staff of a care period in a desired format.
     // Takes pretext as a param to change print format slightly.
-    void print_staff(const std::string& pretext);
+    // Names of the staff are taken from the given symbol table.
+    void print_staff(ReportWriter& out, const std::string& pretext,
+                     const SymbolTable& staff_names);
+
+    // Getter method to get staff of care period.
+    std::vector<Handle> get_staff() const;
+
+    // Staff of care period in ascending order of handles, without copying
+    // them.
+    const Handle* staff_begin() const;
+    const Handle* staff_end() const;
 
     // Method to know if careperiod is still active.
     bool is_it_active();
 
-    // Get name of patient who is treated in this care
+    // Get id of patient who is treated in this care
     // period.
-    std::string get_name();
+    Handle get_patient_id();
+
+    // Getter method to get the position of care period in creation order.
+    unsigned int get_number() const;
 
     // Method to set care_period inactive.
     void set_careperiod_inactive();
 
     // Method to find, if staff is found from this
     // care period.
-    bool find_staff(std::string staff_name);
+    bool find_staff(Handle staff_member);
 
     // Method to print start and end date in a desired format.
     // Takes pretext as a param to change print format slightly.
-    void print_date_info(const std::string& pretext);
+    void print_date_info(ReportWriter& out, const std::string& pretext);
 
 private:
 
@@ -76,8 +94,15 @@ private:
     // End date of care period.
     Date end_;
 
-    // Staff personnel in alphabetical order in a set.
-    std::set<std::string> staff_of_patient_;
+    // Position of care period in creation order (first is 0).
+    unsigned int number_;
+
+    // Number of staff members stored inside the care period before the
+    // set moves them to the heap. Most care periods have only a few.
+    static const unsigned int INLINE_STAFF = 4;
+
+    // Staff personnel in a sorted set.
+    SmallSet<Handle, INLINE_STAFF> staff_of_patient_;
 
     // Bool to know if period is active or inactive.
     bool is_period_active_;
@@ -0,0 +1,102 @@
+#include "census.hh"
+
+Census::Census():
+    total_(0), closed_count_(0), total_length_(0)
+{
+}
+
+void Census::admit(unsigned int day)
+{
+    add(day, 1);
+}
+
+void Census::discharge(unsigned int admitted, unsigned int day)
+{
+    if ( day < admitted )
+    {
+        add(admitted, -1);
+        return;
+    }
+    add(day + 1ul, -1);
+    ++lengths_[day - admitted];
+    ++closed_count_;
+    total_length_ += day - admitted;
+}
+
+unsigned long Census::occupancy(unsigned int day) const
+{
+    long sum = total_;
+    for ( std::map<unsigned long, long>::const_reverse_iterator iter =
+              changes_.rbegin();
+          iter != changes_.rend() and iter->first > day; ++iter )
+    {
+        sum -= iter->second;
+    }
+    return sum;
+}
+
+void Census::occupancy_changes(
+        unsigned int first, unsigned int last,
+        std::vector<std::pair<unsigned int, unsigned long>>& days) const
+{
+    days.clear();
+    unsigned long count = occupancy(first);
+    days.push_back({first, count});
+    for ( std::map<unsigned long, long>::const_iterator iter =
+              changes_.upper_bound(first);
+          iter != changes_.end() and iter->first <= last; ++iter )
+    {
+        count += iter->second;
+        days.push_back({iter->first, count});
+    }
+}
+
+unsigned long Census::closed_count() const
+{
+    return closed_count_;
+}
+
+unsigned long Census::total_length() const
+{
+    return total_length_;
+}
+
+unsigned int Census::length_percentile(unsigned int percent) const
+{
+    // Smallest length with at least the given share of lengths up to it.
+    unsigned long needed = (closed_count_ * percent + 99) / 100;
+    unsigned long counted = 0;
+    for ( const std::pair<const unsigned int, unsigned long>& length
+          : lengths_ )
+    {
+        counted += length.second;
+        if ( counted >= needed )
+        {
+            return length.first;
+        }
+    }
+    return 0;
+}
+
+void Census::clear()
+{
+    changes_.clear();
+    total_ = 0;
+    lengths_.clear();
+    closed_count_ = 0;
+    total_length_ = 0;
+}
+
+void Census::add(unsigned long day, long delta)
+{
+    // Days whose changes cancel out are dropped, so that they are not
+    // printed as changes.
+    std::map<unsigned long, long>::iterator iter =
+            changes_.insert({day, 0}).first;
+    iter->second += delta;
+    total_ += delta;
+    if ( iter->second == 0 )
+    {
+        changes_.erase(iter);
+    }
+}
@@ -0,0 +1,80 @@
+/* Class Census
+ * ----------
+ * COMP.CS.110 SPRING 2021
+ * ----------
+ * Class for statistics of care periods: the number of patients in the
+ * hospital on each day and the lengths of stay of closed care periods.
+ *
+ * Admissions and discharges are kept as changes of the number of patients
+ * by day: an admission adds one on its day and a discharge subtracts one
+ * on the day after it. The number of patients on a day is then the sum of
+ * the changes up to that day. Only days with changes are kept, in an
+ * ordered map, so memory grows with the number of care periods however far
+ * apart their dates are, and a census goes through the days with changes
+ * instead of every calendar day. Lengths of stay are counted in a
+ * histogram.
+ *
+ * Days are day numbers of dates (see Date). Care periods that have not
+ * ended count on every day from their start on.
+ * */
+#ifndef CENSUS_HH
+#define CENSUS_HH
+
+#include <map>
+#include <utility>
+#include <vector>
+
+class Census
+{
+public:
+    // Constructor.
+    Census();
+
+    // Adds a care period starting on the given day.
+    void admit(unsigned int day);
+
+    // Ends a care period added earlier with the given start day. Care
+    // periods ending before they start are removed altogether.
+    void discharge(unsigned int admitted, unsigned int day);
+
+    // Returns the number of care periods going on on the given day.
+    unsigned long occupancy(unsigned int day) const;
+
+    // Finds the number of care periods going on on the first day, and on
+    // every later day up to the last one on which the number changes.
+    void occupancy_changes(
+            unsigned int first, unsigned int last,
+            std::vector<std::pair<unsigned int, unsigned long>>& days) const;
+
+    // Returns the number of closed care periods and the sum of their
+    // lengths in days.
+    unsigned long closed_count() const;
+    unsigned long total_length() const;
+
+    // Returns the shortest length of stay that is at least as long as
+    // the given percentage of closed care periods. Zero if there are none.
+    unsigned int length_percentile(unsigned int percent) const;
+
+    // Removes all care periods.
+    void clear();
+
+private:
+    // Changes in the number of care periods by day, only days whose change
+    // is not zero. Days are one past the day numbers of discharges, so they
+    // are wider than day numbers.
+    std::map<unsigned long, long> changes_;
+
+    // Sum of all changes. The number of care periods on a day is counted
+    // back from it over the later changes, so recent days are counted fast.
+    long total_;
+
+    // Number of closed care periods by their length.
+    std::map<unsigned int, unsigned long> lengths_;
+    unsigned long closed_count_;
+    unsigned long total_length_;
+
+    // Adds delta to the changes of the given day.
+    void add(unsigned long day, long delta);
+};
+
+#endif // CENSUS_HH
@@ -1,14 +1,28 @@
 #include "cli.hh"
 #include "utils.hh"
-#include <fstream>
-#include <sstream>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <thread>
+#include <unistd.h>
 
 
 Cli::Cli(Hospital* hospital, const std::string& prompt):
     hospital_(hospital),
     prompt_(prompt),
-    can_start(hospital != nullptr)
+    can_start(hospital != nullptr),
+    background_(false),
+    statistics_(false)
 {
+    latencies_.resize(cmds_.size());
+    for ( Cmd& command : cmds_ )
+    {
+        for ( const std::string& alias : command.aliases )
+        {
+            aliases_.insert({alias, &command});
+        }
+    }
 }
 
 bool Cli::exec()
@@ -18,17 +32,26 @@ bool Cli::exec()
         std::cout << UNINITIALIZED << std::endl;
         return false;
     }
-    std::vector<std::string> input;
-    std::string cmd;
+    // Output of the reports finished in the background, and of a failed
+    // journal commit.
+    hospital_->commit_journal();
+    reports_.write_finished(hospital_->output());
+    hospital_->output().flush();
+
+    std::vector<std::string_view> input;
+    std::string line;
     std::cout << prompt_;
-    std::getline(std::cin, cmd);
-    input = utils::split(cmd, ' ');
-    if( input.empty() )
+    std::getline(std::cin, line);
+
+    // The command and its parameters point into the line.
+    char* cursor = &line[0];
+    char* end = cursor + line.size();
+    std::string_view cmd;
+    if( not utils::next_token(cursor, end, ' ', cmd) and cmd.empty() )
     {
         return true;
     }
-    cmd = input.front();
-    pop_front(input);
+    utils::split(cursor, end, ' ', input);
     Cmd* func = find_command(cmd);
     if ( func == nullptr )
     {
@@ -39,6 +62,8 @@ bool Cli::exec()
     // The number of parameters of commands Quit and Help does not matter
     if ( func->name == "Quit" )
     {
+        reports_.write_all(hospital_->output());
+        hospital_->output().flush();
         return false;
     }
 
@@ -48,57 +73,247 @@ bool Cli::exec()
         return true;
     }
 
+    // The print command given to As of has parameters of its own.
+    if ( func->name == "As of" )
+    {
+        reports_.write_all(hospital_->output());
+        as_of(input);
+        hospital_->output().flush();
+        return true;
+    }
+
     if ( func->params.size() != input.size() )
     {
         std::cout << WRONG_PARAMETERS << std::endl;
         return true;
     }
 
+    if ( func->read_only and background_ )
+    {
+        reports_.start(*hospital_, func->func_ptr, input);
+        return true;
+    }
+
+    if ( func->name == "Background reports" )
+    {
+        background_reports(input.at(0));
+        hospital_->output().flush();
+        return true;
+    }
+
+    if ( func->name == "Statistics" )
+    {
+        print_statistics(hospital_->output());
+        hospital_->output().flush();
+        return true;
+    }
+
+    // Reports started earlier are printed before the output of a file.
+    reports_.write_all(hospital_->output());
+    hospital_->output().flush();
+
     if ( func->name == "Read" )
     {
-        if ( not read_from_file(input.at(0)) )
+        std::string filename(input.at(0));
+        if ( not read_from_file(filename) )
         {
             std::cout << FILE_READING_ERROR << std::endl;
             return false;
         }
         else
         {
-            std::cout << FILE_READING_OK << input.at(0) << std::endl;
+            std::cout << FILE_READING_OK << filename << std::endl;
         }
         return true;
     }
 
-    // Call to member func ptr: (OBJ ->* FUNC_PTR)(PARAMS)
-    (hospital_->*(func->func_ptr))(input);
+    if ( func->name == "Replay" )
+    {
+        if ( not execute_replay(std::string(input.at(0))) )
+        {
+            std::cout << FILE_READING_ERROR << std::endl;
+        }
+        return true;
+    }
+
+    if ( func->name == "Batch" or func->name == "Batch verbose" )
+    {
+        if ( not execute_batch(std::string(input.at(0)),
+                               func->name == "Batch verbose") )
+        {
+            std::cout << FILE_READING_ERROR << std::endl;
+        }
+        return true;
+    }
+
+    call(func, input);
+    hospital_->output().flush();
     return true;
 }
 
-void Cli::pop_front(std::vector<std::string> &vec)
+bool Cli::exec_pipe()
 {
-    vec.erase(vec.begin(), ++vec.begin());
+    if( not can_start )
+    {
+        std::cout << UNINITIALIZED << std::endl;
+        return false;
+    }
+    // Complete lines of whatever has been read are run, and the rest of
+    // the last line is moved to the start of the buffer to wait for more.
+    // A read returns as soon as anything has been written into the pipe,
+    // so commands run as they arrive.
+    BatchResult result = {0, 0};
+    std::string buffer;
+    std::size_t kept = 0;
+    bool cont = true;
+    while ( cont )
+    {
+        // Reading may wait for the writer of the pipe.
+        hospital_->commit_journal();
+        reports_.write_finished(hospital_->output());
+        hospital_->output().flush();
+        std::cout.flush();
+        buffer.resize(kept + PIPE_BLOCK_SIZE);
+        ssize_t got = ::read(STDIN_FILENO, &buffer[kept], PIPE_BLOCK_SIZE);
+        if ( got < 0 and errno == EINTR )
+        {
+            continue;
+        }
+        bool is_at_end = got <= 0;
+        std::size_t size = kept + (is_at_end ? 0 : got);
+        char* line = &buffer[0];
+        char* end = line + size;
+        if ( not is_at_end )
+        {
+            // More input follows, the last incomplete line waits for it.
+            // Only the new characters can have the last line break.
+            std::string_view received(&buffer[kept], got);
+            std::string_view::size_type last = received.rfind('\n');
+            end = last == std::string_view::npos ? line
+                                                 : &buffer[kept + last] + 1;
+        }
+        cont = run_lines(line, end, true, result) and not is_at_end;
+        kept = size - (end - &buffer[0]);
+        std::copy(end, end + kept, &buffer[0]);
+    }
+    reports_.write_all(hospital_->output());
+    hospital_->output().flush();
+    return result.errors == 0;
 }
 
-Cmd *Cli::find_command(const std::string& cmd)
+Cmd *Cli::find_command(std::string_view cmd)
 {
-    std::string upper_cmd = cmd;
-    for ( unsigned int i = 0; i < cmd.size(); ++i )
+    AliasMap::const_iterator command = aliases_.find(cmd);
+    if ( command == aliases_.end() )
     {
-        upper_cmd.at(i) = std::toupper(cmd.at(i));
+        return nullptr;
     }
-    for ( auto command = cmds_.begin(); command != cmds_.end(); ++command )
+    return command->second;
+}
+
+const std::vector<Cmd>& Cli::get_commands() const
+{
+    return cmds_;
+}
+
+void Cli::set_background_reports(bool background)
+{
+    if ( not background )
     {
-        for ( auto alias : command->aliases )
+        reports_.write_all(hospital_->output());
+        reports_.stop_following(*hospital_);
+    }
+    background_ = background;
+}
+
+void Cli::set_statistics(bool collect)
+{
+    statistics_ = collect;
+}
+
+void Cli::print_statistics(ReportWriter& out) const
+{
+    bool is_found = false;
+    for ( unsigned int i = 0; i < cmds_.size(); ++i )
+    {
+        const LatencyHistogram& latency = latencies_.at(i);
+        if ( latency.count() == 0 )
         {
-            if ( alias == upper_cmd )
-            {
-                return &(*command);
-            }
+            continue;
         }
+        out << cmds_.at(i).name << ": count " << latency.count()
+            << ", p50 " << latency.percentile(50)
+            << " ns, p99 " << latency.percentile(99)
+            << " ns, max " << latency.longest() << " ns\n";
+        is_found = true;
+    }
+    if ( not is_found )
+    {
+        out << "None" << '\n';
+    }
+}
+
+void Cli::call(Cmd* func, Params params)
+{
+    if ( not statistics_ )
+    {
+        // Call to member func ptr: (OBJ ->* FUNC_PTR)(PARAMS)
+        (hospital_->*(func->func_ptr))(params);
+        return;
+    }
+    std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now();
+    (hospital_->*(func->func_ptr))(params);
+    std::chrono::nanoseconds elapsed =
+            std::chrono::steady_clock::now() - start;
+    latencies_.at(func - cmds_.data()).record(elapsed.count());
+}
+
+bool Cli::background_reports(std::string_view setting)
+{
+    if ( setting != "on" and setting != "off" )
+    {
+        hospital_->output() << ON_OR_OFF_ERROR << '\n';
+        return false;
+    }
+    set_background_reports(setting == "on");
+    hospital_->output() << (background_ ? BACKGROUND_ON : BACKGROUND_OFF)
+                        << '\n';
+    return true;
+}
+
+bool Cli::as_of(Params params)
+{
+    ReportWriter& out = hospital_->output();
+    if ( params.size() < 2 )
+    {
+        out << WRONG_PARAMETERS << '\n';
+        return false;
     }
-    return nullptr;
+    Cmd* func = find_command(params.at(1));
+    if ( func == nullptr )
+    {
+        out << UNKNOWN_CMD << '\n';
+        return false;
+    }
+    if ( not func->read_only )
+    {
+        out << AS_OF_ERROR << '\n';
+        return false;
+    }
+    std::vector<std::string_view> command_params(params.begin() + 2,
+                                                 params.end());
+    if ( func->params.size() != command_params.size() )
+    {
+        out << WRONG_PARAMETERS << '\n';
+        return false;
+    }
+    unsigned long errors_before = hospital_->error_count();
+    hospital_->print_as_of(params.at(0), func->func_ptr, command_params);
+    return hospital_->error_count() == errors_before;
 }
 
-void Cli::print_help(const std::vector<std::string>& params)
+void Cli::print_help(Params params)
 {
     if ( params.size() != 0 )
     {
@@ -138,21 +353,281 @@ void Cli::print_cmd_info(Cmd* cmd, bool longer) const
 
 bool Cli::read_from_file(const std::string &filename)
 {
-    std::ifstream inputfile(filename);
-    if ( not inputfile )
+    BatchResult result = {0, 0};
+    return run_batch(filename, false, result);
+}
+
+bool Cli::run_batch(const std::string& filename, bool show_output,
+                    BatchResult& result)
+{
+    // Read the whole file at once.
+    std::string buffer;
+    if ( not utils::read_file(filename, buffer) )
+    {
+        return false;
+    }
+
+    // All output of the batch goes through the output of the hospital.
+    ReportWriter& out = hospital_->output();
+    bool was_discarding = out.is_discarding();
+    out.set_discard(was_discarding or not show_output);
+
+    char* line = &buffer[0];
+    run_lines(line, line + buffer.size(), show_output, result);
+
+    out.set_discard(was_discarding);
+    return true;
+}
+
+bool Cli::run_lines(char*& line, char* end, bool show_output,
+                    BatchResult& result)
+{
+    // Commands and parameters point into the lines.
+    std::vector<std::string_view> input;
+    std::string_view cmd;
+    while ( line < end )
+    {
+        char* line_end = std::find(line, end, '\n');
+        char* cursor = line;
+        bool has_params = utils::next_token(cursor, line_end, ' ', cmd);
+        line = line_end < end ? line_end + 1 : end;
+        if ( has_params or not cmd.empty() )
+        {
+            utils::split(cursor, line_end, ' ', input);
+            if ( not run_batch_command(cmd, input, show_output, result) )
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool Cli::run_batch_command(std::string_view cmd, Params input,
+                            bool show_output, BatchResult& result)
+{
+    ++result.commands;
+    Cmd* func = find_command(cmd);
+    if ( func == nullptr )
+    {
+        ++result.errors;
+        hospital_->output() << UNKNOWN_CMD << '\n';
+        return true;
+    }
+
+    if ( func->name == "Quit" )
     {
         return false;
     }
-    // Redirect the file to cin and save the old cin
-    auto cinbuf = std::cin.rdbuf(inputfile.rdbuf());
-    std::ostringstream unwanted_output;
-    auto coutbuf = std::cout.rdbuf(unwanted_output.rdbuf());
 
-    while( exec() ){}
+    if ( func->name == "Help" )
+    {
+        if ( show_output )
+        {
+            hospital_->output().flush();
+            print_help(input);
+        }
+        return true;
+    }
+
+    if ( func->name == "As of" )
+    {
+        if ( show_output and not as_of(input) )
+        {
+            ++result.errors;
+        }
+        return true;
+    }
 
-    std::cin.rdbuf(cinbuf);
-    std::cout.rdbuf(coutbuf);
-    inputfile.close();
+    if ( func->params.size() != input.size() )
+    {
+        ++result.errors;
+        hospital_->output() << WRONG_PARAMETERS << '\n';
+        return true;
+    }
 
+    if ( func->name == "Background reports" )
+    {
+        if ( not background_reports(input.at(0)) )
+        {
+            ++result.errors;
+        }
+        return true;
+    }
+
+    if ( func->name == "Statistics" )
+    {
+        if ( show_output )
+        {
+            print_statistics(hospital_->output());
+        }
+        return true;
+    }
+
+    // Files read from the batch are executed in the same batch. Only
+    // verbose batches show output.
+    if ( func->func_ptr == nullptr )
+    {
+        bool nested_output = show_output and func->name == "Batch verbose";
+        if ( not run_batch(std::string(input.at(0)), nested_output, result) )
+        {
+            ++result.errors;
+            hospital_->output() << FILE_READING_ERROR << '\n';
+            return false;
+        }
+        return true;
+    }
+
+    if ( func->read_only and not show_output )
+    {
+        return true;
+    }
+
+    unsigned long errors_before = hospital_->error_count();
+    call(func, input);
+    if ( hospital_->error_count() != errors_before )
+    {
+        ++result.errors;
+    }
+    return true;
+}
+
+bool Cli::execute_batch(const std::string& filename, bool show_output)
+{
+    BatchResult result = {0, 0};
+    std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now();
+    if ( not run_batch(filename, show_output, result) )
+    {
+        return false;
+    }
+    hospital_->output().flush();
+    std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+    print_batch_result(filename, result, elapsed.count());
+    return true;
+}
+
+bool Cli::execute_replay(const std::string& filename)
+{
+    BatchResult result = {0, 0};
+    std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now();
+    std::string buffer;
+    if ( not utils::read_file(filename, buffer) )
+    {
+        return false;
+    }
+
+    // Changes recorded into a journal must be run one at a time, and a
+    // single thread is faster without dividing and merging.
+    unsigned int threads = std::thread::hardware_concurrency();
+    ParallelReplay replay(threads);
+    char* line = &buffer[0];
+    // If the shards can't be merged, the commands are run one at a time.
+    if ( threads < 2 or hospital_->is_journaled() or
+         not add_replay_commands(line, line + buffer.size(), replay,
+                                 result) or
+         not replay.run(*hospital_, result.errors) )
+    {
+        result = {0, 0};
+        if ( not run_batch(filename, false, result) )
+        {
+            return false;
+        }
+    }
+    hospital_->output().flush();
+    std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+    print_batch_result(filename, result, elapsed.count());
+    return true;
+}
+
+bool Cli::add_replay_commands(char* line, char* end, ParallelReplay& replay,
+                              BatchResult& result)
+{
+    // Commands are counted like in run_batch_command, the commands that
+    // only print something are skipped.
+    std::vector<std::string_view> input;
+    std::string_view cmd;
+    while ( line < end )
+    {
+        char* line_end = std::find(line, end, '\n');
+        char* cursor = line;
+        bool has_params = utils::next_token(cursor, line_end, ' ', cmd);
+        line = line_end < end ? line_end + 1 : end;
+        if ( not has_params and cmd.empty() )
+        {
+            continue;
+        }
+        utils::split(cursor, line_end, ' ', input);
+        ++result.commands;
+        Cmd* func = find_command(cmd);
+        if ( func == nullptr )
+        {
+            ++result.errors;
+            continue;
+        }
+        if ( func->name == "Quit" )
+        {
+            return true;
+        }
+        if ( func->name == "Help" or func->name == "As of" )
+        {
+            continue;
+        }
+        if ( func->params.size() != input.size() )
+        {
+            ++result.errors;
+            continue;
+        }
+        if ( func->read_only )
+        {
+            continue;
+        }
+        if ( func->func_ptr == nullptr or
+             not replay.add(func->func_ptr, input) )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Cli::print_batch_result(const std::string& filename,
+                             const BatchResult& result, double milliseconds)
+{
+    std::cout << FILE_READING_OK << filename << std::endl;
+    std::cout << BATCH_COMMANDS << result.commands << std::endl;
+    std::cout << BATCH_ERRORS << result.errors << std::endl;
+    std::cout << BATCH_TIME << milliseconds << std::endl;
+}
+
+std::size_t AliasHash::operator()(std::string_view alias) const
+{
+    // FNV-1a of the upper case characters.
+    std::size_t hash = 2166136261u;
+    for ( char cha : alias )
+    {
+        hash ^= static_cast<unsigned char>(std::toupper(cha));
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+bool AliasEqual::operator()(std::string_view lhs,
+                            std::string_view rhs) const
+{
+    if ( lhs.size() != rhs.size() )
+    {
+        return false;
+    }
+    for ( unsigned int i = 0; i < lhs.size(); ++i )
+    {
+        if ( std::toupper(lhs.at(i)) != std::toupper(rhs.at(i)) )
+        {
+            return false;
+        }
+    }
     return true;
 }
@@ -12,21 +12,51 @@
 #define CLI_HH
 
 #include "hospital.hh"
+#include "latencyhistogram.hh"
+#include "parallelreplay.hh"
+#include "reportrunner.hh"
 #include <string>
+#include <string_view>
 #include <iostream>
+#include <unordered_map>
 #include <vector>
 
 // Declares a type of function called.
-using MemberFunc = void (Hospital::*)(const std::vector<std::string>& params);
+using MemberFunc = void (Hospital::*)(Params params);
 
 
 // Struct that 'defines' a function.
+// Commands that only print information are marked read_only, batch
+// execution skips them when their output is not wanted.
 struct Cmd
 {
     std::vector<std::string> aliases;
     std::string name;
     std::vector<std::string> params;
     MemberFunc func_ptr;
+    bool read_only;
+};
+
+// Case-insensitive hash and comparison of command aliases.
+struct AliasHash
+{
+    std::size_t operator()(std::string_view alias) const;
+};
+struct AliasEqual
+{
+    bool operator()(std::string_view lhs, std::string_view rhs) const;
+};
+
+// Commands by their aliases, whatever case the aliases are written in.
+// The keys point to the aliases stored in the commands.
+using AliasMap =
+    std::unordered_map<std::string_view, Cmd*, AliasHash, AliasEqual>;
+
+// Counters of a batch execution.
+struct BatchResult
+{
+    unsigned long commands;
+    unsigned long errors;
 };
 
 // Error strings.
@@ -35,6 +65,14 @@ const std::string WRONG_PARAMETERS = "Error: Wrong amount of parameters.";
 const std::string UNKNOWN_CMD = "Error: Unknown commands given.";
 const std::string FILE_READING_ERROR = "Error: Can't read given file.";
 const std::string FILE_READING_OK = "Input read from file: ";
+const std::string BATCH_COMMANDS = "Commands processed: ";
+const std::string BATCH_ERRORS = "Errors: ";
+const std::string BATCH_TIME = "Elapsed time (ms): ";
+const std::string BACKGROUND_ON = "Reports are run in the background.";
+const std::string BACKGROUND_OFF = "Reports are run in the foreground.";
+const std::string ON_OR_OFF_ERROR = "Error: Expected on or off.";
+const std::string AS_OF_ERROR =
+        "Error: Only print commands can be run as of a date.";
 
 class Cli
 {
@@ -52,30 +90,62 @@ public:
      */
     bool exec();
 
-private:
     /**
-     * @brief pop_front
-     * @param vec
-     * vector utility func that erases the first element of given vector.
-     *
-     * @note All iterators to the container are invalitaded
+     * @brief exec_pipe
+     * @return false if any command failed, true otherwise.
+     * Runs the commands read from std::cin without prompts, like the
+     * commands of a verbose batch file. Input is read in large blocks, and
+     * commands are run until the end of the input or the first Quit.
      */
-    void pop_front(std::vector<std::string>& vec);
+    bool exec_pipe();
 
     /**
      * @brief find_command
      * @param cmd
      * @return Cmd pointer if one with given alias is found.
      */
-    Cmd* find_command(const std::string& cmd);
+    Cmd* find_command(std::string_view cmd);
+
+    /**
+     * @brief get_commands
+     * @return all commands of the cli.
+     */
+    const std::vector<Cmd>& get_commands() const;
 
+    /**
+     * @brief set_background_reports
+     * @param background
+     * If background is true, print commands given to exec are run on a
+     * worker thread against the state of the hospital when they were given,
+     * and their output is printed in order before the first prompt after
+     * they have finished, or when the program quits.
+     */
+    void set_background_reports(bool background);
+
+    /**
+     * @brief set_statistics
+     * @param collect
+     * If collect is true, the number of calls and the time taken by each
+     * command are recorded. Otherwise commands are called without timing.
+     */
+    void set_statistics(bool collect);
+
+    /**
+     * @brief print_statistics
+     * @param out
+     * Prints the number of calls and median, 99th percentile and longest
+     * time in nanoseconds of each command called.
+     */
+    void print_statistics(ReportWriter& out) const;
+
+private:
     /**
      * @brief print_help
      * @param params
      * Generate and print a help, either generic ( no params ) or
      * specific ( func name as param )
      */
-    void print_help(const std::vector<std::string>& params);
+    void print_help(Params params);
 
     /**
      * @brief print_cmd_info
@@ -96,36 +166,176 @@ private:
      */
     bool read_from_file(const std::string& filename);
 
+    /**
+     * @brief run_batch
+     * @param filename
+     * @param show_output if false, output of the commands is discarded and
+     * commands that only print something are skipped.
+     * @param result counters updated with the commands run from the file.
+     * @return false if file could not be read, true otherwise.
+     *
+     * Reads the whole file into memory and executes its commands one by
+     * one straight in the hospital. Stops at the end of the file or at
+     * the first Quit command.
+     */
+    bool run_batch(const std::string& filename, bool show_output,
+                   BatchResult& result);
+
+    /**
+     * @brief run_lines
+     * @param line first character of the commands, moved past the lines
+     * that were run.
+     * @param end end of the commands.
+     * @param show_output
+     * @param result
+     * @return false if a Quit command was found, true otherwise.
+     *
+     * Runs the commands one line at a time. The last line does not need
+     * to end with a newline.
+     */
+    bool run_lines(char*& line, char* end, bool show_output,
+                   BatchResult& result);
+
+    /**
+     * @brief run_batch_command
+     * @param cmd
+     * @param params
+     * @param show_output
+     * @param result
+     * @return false if the batch should stop, true otherwise.
+     */
+    bool run_batch_command(std::string_view cmd, Params params,
+                           bool show_output, BatchResult& result);
+
+    /**
+     * @brief execute_batch
+     * @param filename
+     * @param show_output
+     * @return false if file could not be read, true otherwise.
+     * Executes the given file in batch mode and prints the number of
+     * commands, errors and the time used.
+     */
+    bool execute_batch(const std::string& filename, bool show_output);
+
+    /**
+     * @brief execute_replay
+     * @param filename
+     * @return false if file could not be read, true otherwise.
+     * Executes the given file like a batch without output, dividing the
+     * commands between threads by patients. Files with commands other than
+     * changes of staff, patients, medicines and dates, hospitals with a
+     * journal, and machines with a single thread execute serially instead.
+     */
+    bool execute_replay(const std::string& filename);
+
+    /**
+     * @brief add_replay_commands
+     * @param line first character of the commands.
+     * @param end end of the commands.
+     * @param replay
+     * @param result counters updated with the commands not given to replay.
+     * @return false if some command can't be replayed in parallel.
+     */
+    bool add_replay_commands(char* line, char* end, ParallelReplay& replay,
+                             BatchResult& result);
+
+    /**
+     * @brief print_batch_result
+     * @param filename
+     * @param result
+     * @param milliseconds
+     * Prints the number of commands and errors of a batch and the time
+     * used.
+     */
+    void print_batch_result(const std::string& filename,
+                            const BatchResult& result, double milliseconds);
+
+    /**
+     * @brief background_reports
+     * @param setting "on" or "off"
+     * @return false if setting is neither of them, true otherwise.
+     * Implements the Background reports command.
+     */
+    bool background_reports(std::string_view setting);
+
+    /**
+     * @brief as_of
+     * @param params date, print command and its parameters
+     * @return false if the command failed, true otherwise.
+     * Implements the As of command.
+     */
+    bool as_of(Params params);
+
+    /**
+     * @brief call
+     * @param func
+     * @param params
+     * Calls the member function of the command, timing it if statistics
+     * are collected.
+     */
+    void call(Cmd* func, Params params);
+
+    // Number of characters read from the standard input at most at a time
+    // in exec_pipe.
+    static const std::size_t PIPE_BLOCK_SIZE = 1 << 20;
+
     Hospital* hospital_;
     std::string prompt_;
     bool can_start;
 
+    // Print commands run in the background, if background_ is true.
+    ReportRunner reports_;
+    bool background_;
+
+    // Times taken by the commands, in the same order as cmds_, if
+    // statistics_ is true.
+    std::vector<LatencyHistogram> latencies_;
+    bool statistics_;
+
     // Vector that stores all cmd info.
     // Exceptionally the lines below may exceed 80 characters,
     // but otherwise the text would be less readable.
     std::vector<Cmd> cmds_ =
     {
-        {{"RECRUIT", "R"},"Recruit staff",{"staff member id"},&Hospital::recruit},
-        {{"ENTER", "E"},"Take patient to hospital",{"patient id"},&Hospital::enter},
-        {{"LEAVE", "L"},"Take patient from hospital",{"patient id"},&Hospital::leave},
-        {{"ASSIGN_STAFF", "AS"},"Assign staff for a patient", {"staff member id","patient id"},&Hospital::assign_staff},
-        {{"ADD_MEDICINE", "AM"},"Add medicine for a patient",{"medicine name","strength","dosage","patient id"},&Hospital::add_medicine},
-        {{"REMOVE_MEDICINE", "RM"},"Remove medicine from a patient",{"medicine name", "patient id"},&Hospital::remove_medicine},
-        //{{"PRINT_PATIENT_MEDICINES", "PPM"},"Print patient's medicines",{"patient id"},&Hospital::print_patient_medicines},
-        {{"PRINT_PATIENT_INFO", "PPI"},"Print patient's info",{"patient id"},&Hospital::print_patient_info},
-        //{{"PRINT_PATIENTS", "PPS"},"Print patients per staff",{"staff member id"},&Hospital::print_patients_per_staff},
-        {{"PRINT_CARE_PERIODS", "PCPS"},"Print care periods per staff",{"staff member id"},&Hospital::print_care_periods_per_staff},
-        {{"PRINT_ALL_MEDICINES", "PAM"},"Print all used medicines",{},&Hospital::print_all_medicines},
-        {{"PRINT_ALL_STAFF", "PAS"},"Print all staff",{},&Hospital::print_all_staff},
-        {{"PRINT_ALL_PATIENTS", "PAP"},"Print all patients",{},&Hospital::print_all_patients},
-        {{"PRINT_CURRENT_PATIENTS", "PCP"},"Print current patients",{},&Hospital::print_current_patients},
-        {{"SET_DATE", "SD"},"Set date",{"day","month","year"},&Hospital::set_date},
-        {{"ADVANCE_DATE", "AD"},"Advance date",{"amount"},&Hospital::advance_date},
-        {{"READ_FROM", "RF"}, "Read", {"filename"},nullptr},
-        {{"HELP", "H"},"Help",{"function"},nullptr},
-        {{"QUIT", "Q"}, "Quit",{},nullptr}
+        {{"RECRUIT", "R"},"Recruit staff",{"staff member id"},&Hospital::recruit,false},
+        {{"ENTER", "E"},"Take patient to hospital",{"patient id"},&Hospital::enter,false},
+        {{"LEAVE", "L"},"Take patient from hospital",{"patient id"},&Hospital::leave,false},
+        {{"ASSIGN_STAFF", "AS"},"Assign staff for a patient", {"staff member id","patient id"},&Hospital::assign_staff,false},
+        {{"ADD_MEDICINE", "AM"},"Add medicine for a patient",{"medicine name","strength","dosage","patient id"},&Hospital::add_medicine,false},
+        {{"REMOVE_MEDICINE", "RM"},"Remove medicine from a patient",{"medicine name", "patient id"},&Hospital::remove_medicine,false},
+        //{{"PRINT_PATIENT_MEDICINES", "PPM"},"Print patient's medicines",{"patient id"},&Hospital::print_patient_medicines,true},
+        {{"PRINT_PATIENT_INFO", "PPI"},"Print patient's info",{"patient id"},&Hospital::print_patient_info,true},
+        //{{"PRINT_PATIENTS", "PPS"},"Print patients per staff",{"staff member id"},&Hospital::print_patients_per_staff,true},
+        {{"PRINT_PATIENTS_ON", "PPO"},"Print patients on date",{"date (ddmmyyyy)"},&Hospital::print_patients_on,true},
+        {{"PRINT_PATIENTS_BETWEEN", "PPB"},"Print patients between dates",{"first date (ddmmyyyy)","last date (ddmmyyyy)"},&Hospital::print_patients_between,true},
+        {{"CENSUS", "C"},"Print census",{"first date (ddmmyyyy)","last date (ddmmyyyy)"},&Hospital::print_census,true},
+        {{"LOS_STATS", "LOS"},"Print length of stay statistics",{},&Hospital::print_los_stats,true},
+        {{"SUMMARY", "SU"},"Print summary",{"amount"},&Hospital::print_summary,true},
+        {{"PRINT_CARE_PERIODS", "PCPS"},"Print care periods per staff",{"staff member id"},&Hospital::print_care_periods_per_staff,true},
+        {{"PRINT_PRESCRIPTIONS", "PPR"},"Print prescriptions",{"medicine name","first date (ddmmyyyy)","last date (ddmmyyyy)"},&Hospital::print_prescriptions,true},
+        {{"PRINT_ALL_MEDICINES", "PAM"},"Print all used medicines",{},&Hospital::print_all_medicines,true},
+        {{"PRINT_ALL_STAFF", "PAS"},"Print all staff",{},&Hospital::print_all_staff,true},
+        {{"PRINT_ALL_PATIENTS", "PAP"},"Print all patients",{},&Hospital::print_all_patients,true},
+        {{"PRINT_CURRENT_PATIENTS", "PCP"},"Print current patients",{},&Hospital::print_current_patients,true},
+        {{"SET_DATE", "SD"},"Set date",{"day","month","year"},&Hospital::set_date,false},
+        {{"ADVANCE_DATE", "AD"},"Advance date",{"amount"},&Hospital::advance_date,false},
+        {{"SAVE_SNAPSHOT", "SS"},"Save snapshot",{"filename"},&Hospital::save_snapshot,false},
+        {{"LOAD_SNAPSHOT", "LS"},"Load snapshot",{"filename"},&Hospital::load_snapshot,false},
+        {{"EXPORT", "EX"},"Export",{"directory"},&Hospital::export_tables,false},
+        {{"READ_FROM", "RF"}, "Read", {"filename"},nullptr,false},
+        {{"BATCH", "B"}, "Batch", {"filename"},nullptr,false},
+        {{"BATCH_VERBOSE", "BV"}, "Batch verbose", {"filename"},nullptr,false},
+        {{"REPLAY", "RP"}, "Replay", {"filename"},nullptr,false},
+        {{"BACKGROUND_REPORTS", "BR"}, "Background reports", {"on/off"},nullptr,false},
+        {{"STATS", "ST"}, "Statistics", {},nullptr,false},
+        {{"AS_OF", "AO"}, "As of", {"date (ddmmyyyy)","print command and its parameters"},nullptr,false},
+        {{"HELP", "H"},"Help",{"function"},nullptr,false},
+        {{"QUIT", "Q"}, "Quit",{},nullptr,false}
     };
 
+    // All aliases of cmds_, built once in the constructor.
+    AliasMap aliases_;
+
 };
 
 #endif // CLI_HH
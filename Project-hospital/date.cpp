@@ -1,103 +1,148 @@
 #include "date.hh"
 #include "utils.hh"
-#include <iostream>
+#include <limits>
 
 // Number of days in months
 unsigned int const month_sizes[12] = { 31, 28, 31, 30, 31, 30,
                                        31, 31, 30, 31, 30, 31 };
 
+// Days in a 400 year cycle of the Gregorian calendar.
+std::int64_t const DAYS_IN_ERA = 146097;
+
+// Day number of 1.3.0000, the first day of the year when years are counted
+// from March. Putting the leap day at the end of the year makes the
+// conversions below simple.
+std::int64_t const MARCH_FIRST_OF_YEAR_0 = 61;
+
+// Largest day number that can be stored.
+std::int64_t const LAST_DAY_NUMBER = std::numeric_limits<unsigned int>::max();
+
 Date::Date():
-    day_(0), month_(0), year_(0)
+    day_number_(0)
 {
 }
 
-Date::Date(unsigned int day, unsigned int month, unsigned int year)
+Date::Date(unsigned int day, unsigned int month, unsigned int year):
+    day_number_(0)
 {
     set(day, month, year);
 }
 
-Date::Date(const std::string& data_as_str)
+Date::Date(const std::string& data_as_str):
+    day_number_(0)
 {
     std::string day = data_as_str.substr(0, 2);
     std::string month = data_as_str.substr(2, 2);
     std::string year = data_as_str.substr(4, 4);
-    day_ = str_to_date_int(day);
-    month_ = str_to_date_int(month);
-    year_ = str_to_date_int(year);
+    set(str_to_date_int(day), str_to_date_int(month), str_to_date_int(year));
 }
 
 Date::~Date()
 {
 }
 
-void Date::set(unsigned int day, unsigned int month, unsigned int year)
+bool Date::set(unsigned int day, unsigned int month, unsigned int year)
 {
-    day_ = day;
-    month_ = month;
-    year_ = year;
-
-    if( month_ > 12 or month_ < 1 )
+    if( month > 12 or month < 1 )
     {
-        month_ = 1;
+        month = 1;
     }
-    if ( day_ > month_sizes[month_ - 1]
-         or ( month_ == 2 and is_leap_year()
-             and day > month_sizes[month - 1] + 1 ) )
+    if ( day > month_sizes[month - 1] or day < 1 )
     {
-        day_ = 1;
+        day = 1;
     }
+    std::int64_t day_number = to_day_number(day, month, year);
+    if ( day_number > LAST_DAY_NUMBER )
+    {
+        return false;
+    }
+    day_number_ = day_number;
+    return true;
 }
 
 bool Date::is_default() const
 {
-    return day_ == 0 and month_ == 0 and year_ == 0;
+    return day_number_ == 0;
 }
 
-void Date::advance(unsigned int days)
+bool Date::advance(unsigned int days)
 {
-    day_ += days;
-    while ( day_ > month_sizes[month_ - 1] )
+    if ( days > LAST_DAY_NUMBER - day_number_ )
     {
-        if ( month_ == 2 and day_ == 29 and is_leap_year() )
-        {
-            return;
-        }
-        day_ -= month_sizes[month_ - 1];
-        if ( month_ == 2 and is_leap_year() )
-        {
-            --day_;
-        }
-        ++month_;
-
-        if ( month_ > 12 )
-        {
-            month_ -= 12;
-            ++year_;
-        }
+        return false;
     }
+    day_number_ += days;
+    return true;
+}
+
+unsigned int Date::get_day_number() const
+{
+    return day_number_;
 }
 
-void Date::print() const
+void Date::set_day_number(unsigned int day_number)
 {
-    std::cout << day_ << ".";
-    std::cout << month_ << ".";
-    std::cout << year_;
+    day_number_ = day_number;
+}
+
+void Date::print(ReportWriter& out) const
+{
+    unsigned int day = 0;
+    unsigned int month = 0;
+    unsigned int year = 0;
+    if ( not is_default() )
+    {
+        from_day_number(day_number_, day, month, year);
+    }
+    out << day << ".";
+    out << month << ".";
+    out << year;
 }
 
 bool Date::operator==(const Date &rhs) const
 {
-    return day_ == rhs.day_ and month_ == rhs.month_ and year_ == rhs.year_ ;
+    return day_number_ == rhs.day_number_;
 }
 
 bool Date::operator<(const Date &rhs) const
 {
-    return (year_ * 10000 + month_ * 100 + day_ ) <
-           (rhs.year_ * 10000 + rhs.month_ * 100 + rhs.day_);
+    return day_number_ < rhs.day_number_;
 }
 
-bool Date::is_leap_year() const
+std::int64_t Date::to_day_number(unsigned int day, unsigned int month,
+                                 unsigned int year)
 {
-    return (year_ % 4 == 0) and ((year_ % 100 != 0) or (year_ % 400 == 0));
+    // January and February belong to the previous March-based year.
+    std::int64_t march_year = static_cast<std::int64_t>(year)
+                              - (month <= 2 ? 1 : 0);
+    std::int64_t era = (march_year >= 0 ? march_year : march_year - 399)
+                       / 400;
+    std::int64_t year_of_era = march_year - era * 400;
+    std::int64_t day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2)
+                               / 5 + day - 1;
+    std::int64_t day_of_era = year_of_era * 365 + year_of_era / 4
+                              - year_of_era / 100 + day_of_year;
+    return era * DAYS_IN_ERA + day_of_era + MARCH_FIRST_OF_YEAR_0;
+}
+
+void Date::from_day_number(unsigned int day_number, unsigned int& day,
+                           unsigned int& month, unsigned int& year)
+{
+    std::int64_t days = static_cast<std::int64_t>(day_number)
+                        - MARCH_FIRST_OF_YEAR_0;
+    std::int64_t era = (days >= 0 ? days : days - DAYS_IN_ERA + 1)
+                       / DAYS_IN_ERA;
+    std::int64_t day_of_era = days - era * DAYS_IN_ERA;
+    std::int64_t year_of_era = (day_of_era - day_of_era / 1460
+                                + day_of_era / 36524
+                                - day_of_era / (DAYS_IN_ERA - 1)) / 365;
+    std::int64_t day_of_year = day_of_era - (365 * year_of_era
+                                             + year_of_era / 4
+                                             - year_of_era / 100);
+    std::int64_t march_month = (5 * day_of_year + 2) / 153;
+    day = day_of_year - (153 * march_month + 2) / 5 + 1;
+    month = march_month < 10 ? march_month + 3 : march_month - 9;
+    year = year_of_era + era * 400 + (month <= 2 ? 1 : 0);
 }
 
 unsigned int Date::str_to_date_int(const std::string& date_part) const
@@ -111,4 +156,3 @@ unsigned int Date::str_to_date_int(const std::string& date_part) const
         return std::stoi(date_part);
     }
 }
-
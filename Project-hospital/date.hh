@@ -9,6 +9,8 @@
 #ifndef DATE_HH
 #define DATE_HH
 
+#include "reportwriter.hh"
+#include <cstdint>
 #include <string>
 
 class Date
@@ -30,8 +32,9 @@ public:
     // Destructor.
     ~Date();
 
-    // Sets new values for the date.
-    void set(unsigned int day, unsigned int month, unsigned int year);
+    // Sets new values for the date. Returns false and leaves the date
+    // unchanged if the date is too far in the future to be stored.
+    bool set(unsigned int day, unsigned int month, unsigned int year);
 
     // Returns true if the date is a default one,
     // otherwise returns false.
@@ -41,25 +44,36 @@ public:
     bool is_default() const;
 
     // Advances the date with given amount of days.
-    // Can't be anvanced by negative amounts.
-    void advance(unsigned int days);
+    // Can't be anvanced by negative amounts. Returns false and leaves the
+    // date unchanged if the new date is too far in the future to be stored.
+    bool advance(unsigned int days);
+
+    // Getter and setter of the day number, the date as a single integer.
+    // Meant for storing dates in binary files.
+    unsigned int get_day_number() const;
+    void set_day_number(unsigned int day_number);
 
     // Prints the date (dd.mm.yyyy).
-    void print() const;
+    void print(ReportWriter& out) const;
 
     // Comparison operators.
     bool operator==(const Date& rhs) const;
     bool operator<(const Date& rhs) const;
 
 private:
-    // Obvious attributes.
-    unsigned int day_;
-    unsigned int month_;
-    unsigned int year_;
+    // Days since 31.12. of year 0 (1.1.0000 is day 1). Value 0 is reserved
+    // for the default date. Day, month and year are calculated from the
+    // day number only when needed, so advancing and comparing dates are
+    // simple integer operations.
+    unsigned int day_number_;
 
-    // Returns true if the year of the date is a leap year,
-    // otherwise returns false.
-    bool is_leap_year() const;
+    // Conversions between day numbers and day, month and year. Calculated
+    // in 64 bits, because a year that fits in an unsigned int has a day
+    // number that doesn't.
+    static std::int64_t to_day_number(unsigned int day, unsigned int month,
+                                      unsigned int year);
+    static void from_day_number(unsigned int day_number, unsigned int& day,
+                                unsigned int& month, unsigned int& year);
 
     // Converts a date part (day, month, year) from a string to an integer.
     // If a date part begins with zero, drops it away.
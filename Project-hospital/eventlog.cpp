@@ -0,0 +1,112 @@
+#include "eventlog.hh"
+#include "binaryio.hh"
+#include "hospital.hh"
+#include <algorithm>
+
+EventLog::EventLog()
+{
+}
+
+void EventLog::record(Journal::Operation operation,
+                      const std::vector<std::string_view>& params,
+                      unsigned int day, const Hospital& hospital)
+{
+    std::size_t offset = events_.size();
+    Journal::encode(operation, params, events_);
+    add_event(offset, day);
+
+    std::size_t distance = MIN_CHECKPOINT_DISTANCE;
+    if ( not checkpoints_.empty() and
+         checkpoints_.back().snapshot.size() > distance )
+    {
+        distance = checkpoints_.back().snapshot.size();
+    }
+    std::size_t checkpointed = checkpoints_.empty() ? 0 :
+            offset_of(checkpoints_.back().event_count);
+    if ( events_.size() - checkpointed >= distance )
+    {
+        take_checkpoint(hospital);
+    }
+}
+
+void EventLog::append(Journal::Operation operation,
+                      const std::vector<std::string_view>& params,
+                      unsigned int day)
+{
+    std::size_t offset = events_.size();
+    Journal::encode(operation, params, events_);
+    add_event(offset, day);
+}
+
+void EventLog::replace(unsigned int day, const Hospital& hospital)
+{
+    // The replacement is an event without a record, so that the dates of
+    // the events stay in order, and the checkpoint right after it is used
+    // instead of replaying past it.
+    add_event(events_.size(), day);
+    take_checkpoint(hospital);
+}
+
+bool EventLog::is_latest(unsigned int day) const
+{
+    return index_.empty() or index_.back().latest_day <= day;
+}
+
+void EventLog::rebuild(unsigned int day, Hospital& view) const
+{
+    // Events up to the first one on a later day, and the latest checkpoint
+    // among them.
+    std::vector<Event>::const_iterator end =
+            std::upper_bound(index_.begin(), index_.end(), day,
+                             [](unsigned int day, const Event& event)
+                             { return day < event.latest_day; });
+    std::size_t event_count = end - index_.begin();
+    std::vector<Checkpoint>::const_iterator checkpoint =
+            std::upper_bound(checkpoints_.begin(), checkpoints_.end(),
+                             event_count,
+                             [](std::size_t count, const Checkpoint& point)
+                             { return count < point.event_count; });
+
+    ReportWriter& out = view.output();
+    bool was_discarding = out.is_discarding();
+    out.set_discard(true);
+    std::size_t first = 0;
+    if ( checkpoint != checkpoints_.begin() )
+    {
+        --checkpoint;
+        view.read_snapshot(checkpoint->snapshot);
+        first = offset_of(checkpoint->event_count);
+    }
+    std::size_t last = offset_of(event_count);
+
+    // Records are run like when a journal is recovered.
+    BinaryReader records(events_.data() + first, events_.data() + last);
+    std::vector<std::string> values;
+    std::vector<std::string_view> params;
+    while ( not records.at_end() and
+            Journal::run_record(records, view, values, params) )
+    {
+    }
+    out.set_discard(was_discarding);
+}
+
+void EventLog::add_event(std::size_t offset, unsigned int day)
+{
+    if ( not index_.empty() and index_.back().latest_day > day )
+    {
+        day = index_.back().latest_day;
+    }
+    index_.push_back({offset, day});
+}
+
+void EventLog::take_checkpoint(const Hospital& hospital)
+{
+    checkpoints_.push_back({index_.size(), ""});
+    hospital.write_snapshot(checkpoints_.back().snapshot);
+}
+
+std::size_t EventLog::offset_of(std::size_t event_count) const
+{
+    return event_count == index_.size() ? events_.size()
+                                        : index_.at(event_count).offset;
+}
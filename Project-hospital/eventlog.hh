@@ -0,0 +1,96 @@
+/* Class EventLog
+ * ----------
+ * COMP.CS.110 SPRING 2021
+ * ----------
+ * Class for keeping the history of the hospital in memory, so that the
+ * state on an earlier date can be rebuilt. Every change is recorded as an
+ * event tagged with the current date of the hospital, in the compact record
+ * format of the journal. Now and then the whole state is saved as a
+ * checkpoint (a snapshot). A checkpoint is taken when the events recorded
+ * after the latest one take as much memory as that checkpoint, so taking
+ * them costs little per event, and rebuilding a state needs the nearest
+ * checkpoint and a tail of events no larger than it.
+ *
+ * When the state is replaced (e.g. a snapshot is loaded) a checkpoint is
+ * taken at once, because the events before it no longer lead to the state.
+ * */
+#ifndef EVENTLOG_HH
+#define EVENTLOG_HH
+
+#include "journal.hh"
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class Hospital;
+
+class EventLog
+{
+public:
+    // Constructor.
+    EventLog();
+
+    // Records a change made on the given day (day number). The hospital
+    // must already be in the state after the change, in case a checkpoint
+    // is taken.
+    void record(Journal::Operation operation,
+                const std::vector<std::string_view>& params,
+                unsigned int day, const Hospital& hospital);
+
+    // Records a change made on the given day without taking a checkpoint,
+    // for changes made elsewhere (a replay shard). The state must be
+    // replaced with the result after them.
+    void append(Journal::Operation operation,
+                const std::vector<std::string_view>& params,
+                unsigned int day);
+
+    // Records that the state of the hospital was replaced on the given day.
+    void replace(unsigned int day, const Hospital& hospital);
+
+    // Returns true if nothing has been recorded after the given day.
+    bool is_latest(unsigned int day) const;
+
+    // Rebuilds the state at the end of the given day into the view, which
+    // must be a new hospital. The state is the one before the first event
+    // recorded on a later day.
+    void rebuild(unsigned int day, Hospital& view) const;
+
+private:
+    // Events are checkpointed after at least this many bytes even if the
+    // state is smaller.
+    static const std::size_t MIN_CHECKPOINT_DISTANCE = 1 << 16;
+
+    // Start of an event in events_, and the latest day of the events so
+    // far, which never decreases even if the date of the hospital is set
+    // backwards.
+    struct Event
+    {
+        std::size_t offset;
+        unsigned int latest_day;
+    };
+
+    // Snapshot of the state after the given number of events.
+    struct Checkpoint
+    {
+        std::size_t event_count;
+        std::string snapshot;
+    };
+
+    // Records of all events, one after another.
+    std::string events_;
+    std::vector<Event> index_;
+    std::vector<Checkpoint> checkpoints_;
+
+    // Adds an event whose record is already in events_ from the given
+    // offset.
+    void add_event(std::size_t offset, unsigned int day);
+
+    // Saves the state after all events recorded so far.
+    void take_checkpoint(const Hospital& hospital);
+
+    // Returns the offset in events_ after the given number of events.
+    std::size_t offset_of(std::size_t event_count) const;
+};
+
+#endif // EVENTLOG_HH
@@ -1,222 +1,325 @@
 #include "hospital.hh"
 #include "utils.hh"
-#include <iostream>
+#include <algorithm>
+#include <cerrno>
+#include <functional>
 #include <set>
+#include <tuple>
+#include <unordered_map>
+#include <sys/stat.h>
+
+// A new patient record, the patient is in the hospital.
+Hospital::PatientRecord::PatientRecord(Handle patient):
+    person(patient),
+    is_current(true)
+{
+}
 
 // Constructor
-Hospital::Hospital()
+Hospital::Hospital():
+    today_(utils::today),
+    errors_(0),
+    version_(0),
+    journal_(nullptr),
+    history_(nullptr),
+    changes_(nullptr)
 {
 }
 
-// Destructor to deallocate dynamic memory of
-// Person* and CarePeriod*
+// Destructor. Person and CarePeriod objects are released by their pools.
 Hospital::~Hospital()
 {
-    for( std::map<std::string, Person*>::iterator
-         iter = staff_.begin();
-         iter != staff_.end();
-         ++iter )
-    {
-        delete iter->second;
-    }
-    for (std::map<std::string, Person*>::iterator
-         iter = alltime_patients_.begin();
-         iter != alltime_patients_.end();
-         ++iter )
-    {
-        delete iter->second;
-    }
-    for (std::vector<CarePeriod*>::iterator
-         iter = care_periods_in_order_.begin();
-         iter != care_periods_in_order_.end();
-         ++iter )
-    {
-        delete *iter;
-    }
 }
 
 // Used to recruit new staff. If staff already exists,
 // print that staff member already exists.
 void Hospital::recruit(Params params)
 {
-    std::string specialist_id = params.at(0);
+    std::string_view specialist_id = params.at(0);
 
-    if( staff_.find(specialist_id) != staff_.end() )
+    Handle specialist;
+    if( staff_ids_.find(specialist_id, specialist) )
     {
-        std::cout << ALREADY_EXISTS << specialist_id << std::endl;
+        ++errors_;
+        out_ << ALREADY_EXISTS << specialist_id << '\n';
         return;
     }
 
-    Person* new_specialist = new Person(specialist_id);
-    staff_.insert({specialist_id, new_specialist});
-    std::cout << STAFF_RECRUITED << std::endl;
+    specialist = staff_ids_.intern(specialist_id);
+    staff_.push_back(persons_.create(specialist));
+    care_periods_per_staff_.push_back({});
+    record(Journal::RECRUIT, params);
+    out_ << STAFF_RECRUITED << '\n';
 }
 
 // Add entering patient to a hospital. If patient to be added is currently
 // in the hospital, prints that patient already exists in hospital.
-// If patient is new, add patient to alltime_patients_.
+// If patient is new, add a new patient record.
 // If patient is only re-entering hospital, add him to current_patients.
 void Hospital::enter(Params params)
 {
-    std::string patient_name = params.at(0);
+    std::string_view patient_name = params.at(0);
+
+    // Try finding patient from alltime patients.
+    Handle patient;
+    bool is_known = patient_ids_.find(patient_name, patient);
 
     // Find if patient is currently in the hospital.
-    if (current_patients_.find(patient_name) != current_patients_.end())
+    if (is_known and patients_.at(patient)->is_current)
     {
-        std::cout << ALREADY_EXISTS << patient_name << std::endl;
+        ++errors_;
+        out_ << ALREADY_EXISTS << patient_name << '\n';
         return;
     }
-    std::cout << PATIENT_ENTERED << std::endl;
-
-    // Try finding patient from alltime patients.
-    if (alltime_patients_.find(patient_name) != alltime_patients_.end())
+    if (is_known)
     {
-        re_enter_patient(patient_name);
-        return;
+        re_enter_patient(patient);
     }
-    enter_new_patient(patient_name);
+    else
+    {
+        enter_new_patient(patient_name);
+    }
+    record(Journal::ENTER, params);
+    out_ << PATIENT_ENTERED << '\n';
 }
 
 // Used to enter patient that is returning back to the hospital.
-// because patient is returning, we can take a Person* from alltime_patients_,
+// because patient is returning, we can use the existing patient record,
 // but returning patient needs a new careperiod. Patient is put into
 // current_patients_.
-void Hospital::re_enter_patient(std::string patient_name)
+void Hospital::re_enter_patient(Handle patient)
 {
-    Person* new_patient = alltime_patients_.at(patient_name);
-    current_patients_.insert({patient_name, new_patient});
-    // Add a new careperiod to a patient
+    PatientRecord& patient_record = *patients_.at(patient);
+    patient_record.is_current = true;
+    current_patients_.insert(patient);
 
-    CarePeriod* new_care_period = new CarePeriod(utils::today, new_patient);
-    care_periods_.at(patient_name).push_back(new_care_period);
-    care_periods_in_order_.push_back(new_care_period);
+    // Add a new careperiod to a patient
+    patient_record.care_periods.push_back(
+                new_care_period(&patient_record.person));
 }
 
 // Used to enter patient that is completely new one. Patient is new, so
-// we need to create an entirely new Person* object, as well as new CarePeriod*.
-// Put new patient into current_patients_ as well as alltime_patients_.
-void Hospital::enter_new_patient(std::string patient_name)
+// we need to create an entirely new patient record, as well as new
+// CarePeriod*. Put new patient into current_patients_.
+void Hospital::enter_new_patient(std::string_view patient_name)
 {
-    Person* new_patient = new Person(patient_name);
-    current_patients_.insert({patient_name, new_patient});
-    add_alltime_patient(patient_name, new_patient);
+    Handle patient = patient_ids_.intern(patient_name);
+    PatientRecord& patient_record = *patient_pool_.create(patient);
+    patients_.push_back(&patient_record);
+    current_patients_.insert(patient);
 
-    CarePeriod* new_care_period = new CarePeriod(utils::today, new_patient);
-
-    std::vector<CarePeriod*> care_periods_vector = {};
-    care_periods_vector.push_back(new_care_period);
-    care_periods_.insert({patient_name, care_periods_vector});
+    patient_record.care_periods.push_back(
+                new_care_period(&patient_record.person));
+}
 
-    care_periods_in_order_.push_back(new_care_period);
+// Create a care period starting today and store it in creation order.
+CarePeriod* Hospital::new_care_period(Person* patient)
+{
+    CarePeriod* care_period =
+            care_period_pool_.create(today_, patient,
+                                     care_periods_in_order_.size());
+    care_periods_in_order_.push_back(care_period);
+    care_period_index_.insert(today_.get_day_number(),
+                              IntervalIndex::OPEN_END, care_period);
+    census_.admit(today_.get_day_number());
+    return care_period;
 }
 
-// Add a new alltime patient into a data structure.
-void Hospital::add_alltime_patient(std::string patient_name, Person* new_patient)
+// Find a patient from current patients.
+bool Hospital::find_current_patient(std::string_view patient_name,
+                                    Handle& patient) const
 {
-    // Try finding if patient already exists in a alltime_patients_.
-    if (alltime_patients_.find(patient_name) != alltime_patients_.end())
-    {
-        return;
-    }
-    alltime_patients_.insert({patient_name, new_patient});
+    return patient_ids_.find(patient_name, patient) and
+           patients_.at(patient)->is_current;
 }
 
 // Used when current patients leave a hospital. Set end date to careperiod
 // and set the care period inactive. Remove patient from current_patients_.
 void Hospital::leave(Params params)
 {
-    std::string patient_name = params.at(0);
-    // Try finding a patient name from current_patients_.
-    if (current_patients_.find(patient_name) != current_patients_.end())
+    std::string_view patient_name = params.at(0);
+    // Try finding a patient name from current patients.
+    Handle patient;
+    if (find_current_patient(patient_name, patient))
     {
+        PatientRecord& patient_record = *patients_.at(patient);
+        CarePeriod* care_period = patient_record.care_periods.back();
+
         // Update leave date to careperiod.
-        care_periods_.at(patient_name).back()->set_end_date(utils::today);
+        care_period->set_end_date(today_);
+        care_period_index_.set_end(
+                    care_period->get_start_date().get_day_number(),
+                    care_period, today_.get_day_number());
+        census_.discharge(care_period->get_start_date().get_day_number(),
+                          today_.get_day_number());
 
         // Care period has ended, set it inactive.
-        care_periods_.at(patient_name).back()->set_careperiod_inactive();
+        care_period->set_careperiod_inactive();
+        for (const Handle* staff_member = care_period->staff_begin();
+             staff_member != care_period->staff_end(); ++staff_member)
+        {
+            staff_workload_.remove(*staff_member);
+        }
 
         // Erase patient from current patients.
-        current_patients_.erase(patient_name);
+        patient_record.is_current = false;
+        current_patients_.erase(patient);
 
-        std::cout << PATIENT_LEFT << std::endl;
+        record(Journal::LEAVE, params);
+        out_ << PATIENT_LEFT << '\n';
         return;
     }
-    std::cout << CANT_FIND << patient_name << std::endl;
+    ++errors_;
+    out_ << CANT_FIND << patient_name << '\n';
 }
 
 // Assign new staff to a patient if patient exists or if
 // staff exists.
 void Hospital::assign_staff(Params params)
 {
-    std::string staff_name = params.at(0);
-    std::string patient_name = params.at(1);
+    std::string_view staff_name = params.at(0);
+    std::string_view patient_name = params.at(1);
 
     // Check if user gave existing staff member.
-    if (staff_.find(staff_name) == staff_.end() )
+    Handle staff_member;
+    if (not staff_ids_.find(staff_name, staff_member))
     {
-        std::cout << CANT_FIND << staff_name << std::endl;
+        ++errors_;
+        out_ << CANT_FIND << staff_name << '\n';
         return;
     }
 
     // Check if user gave existing patient.
-    if (current_patients_.find(patient_name) == current_patients_.end() )
+    Handle patient;
+    if (not find_current_patient(patient_name, patient))
     {
-        std::cout << CANT_FIND << patient_name << std::endl;
+        ++errors_;
+        out_ << CANT_FIND << patient_name << '\n';
         return;
     }
 
     // Add staff for a chosen patient. Last CarePeriod* element in a vector
     // is always the currently active one, so we can take it.
-    care_periods_.at(patient_name).back()->add_staff(staff_name);
-    std::cout << STAFF_ASSIGNED << patient_name << std::endl;
+    CarePeriod* care_period = patients_.at(patient)->care_periods.back();
+    if (care_period->add_staff(staff_member))
+    {
+        staff_workload_.add(staff_member);
+
+        // Staff works in this care period for the first time. Periods of
+        // the staff member are kept in creation order, and the newest ones
+        // are assigned most often, so search the place from the end.
+        std::vector<CarePeriod*>& staff_periods =
+                care_periods_per_staff_.at(staff_member);
+        std::vector<CarePeriod*>::iterator place = staff_periods.end();
+        while (place != staff_periods.begin() and
+               (*(place - 1))->get_number() > care_period->get_number())
+        {
+            --place;
+        }
+        staff_periods.insert(place, care_period);
+    }
+    record(Journal::ASSIGN_STAFF, params);
+    out_ << STAFF_ASSIGNED << patient_name << '\n';
 }
 // Add medicine to a Person* patient.
 void Hospital::add_medicine(Params params)
 {
-    std::string medicine = params.at(0);
-    std::string strength = params.at(1);
-    std::string dosage = params.at(2);
-    std::string patient = params.at(3);
+    std::string_view medicine = params.at(0);
+    std::string_view strength = params.at(1);
+    std::string_view dosage = params.at(2);
+    std::string_view patient_name = params.at(3);
 
     // Check if given input is proper numeric value. Print accordingly.
     if( not utils::is_numeric(strength, true) or
         not utils::is_numeric(dosage, true) )
     {
-        std::cout << NOT_NUMERIC << std::endl;
+        ++errors_;
+        out_ << NOT_NUMERIC << '\n';
         return;
     }
 
-    std::map<std::string, Person*>::const_iterator
-            patient_iter = current_patients_.find(patient);
-    if( patient_iter == current_patients_.end() )
+    Handle patient;
+    if( not find_current_patient(patient_name, patient) )
     {
-        std::cout << CANT_FIND << patient << std::endl;
+        ++errors_;
+        out_ << CANT_FIND << patient_name << '\n';
         return;
     }
 
-    // Add medicine to patient.
-    patient_iter->second->add_medicine(medicine, stoi(strength), stoi(dosage));
-    std::cout << MEDICINE_ADDED << patient << std::endl;
+    Handle medicine_id = medicine_ids_.intern(medicine);
+    if (medicine_id == patients_per_medicine_.size())
+    {
+        patients_per_medicine_.emplace_back();
+    }
+
+    // Add medicine to patient. A new or changed prescription starts a new
+    // row in the history, and a changed one ends the old row.
+    PatientRecord& patient_record = *patients_.at(patient);
+    unsigned int new_strength = utils::to_number(strength);
+    unsigned int new_dosage = utils::to_number(dosage);
+    unsigned int old_strength = 0;
+    unsigned int old_dosage = 0;
+    bool had_medicine = patient_record.person.get_prescription(
+                medicine_id, old_strength, old_dosage);
+    if (not had_medicine or old_strength != new_strength or
+        old_dosage != new_dosage)
+    {
+        std::map<Handle, unsigned int>::iterator row =
+                patient_record.prescription_rows.find(medicine_id);
+        if (row != patient_record.prescription_rows.end())
+        {
+            prescriptions_.end(row->second, today_.get_day_number());
+        }
+        patient_record.prescription_rows[medicine_id] = prescriptions_.add(
+                    patient_record.care_periods.back()->get_number(),
+                    medicine_id, new_strength, new_dosage,
+                    today_.get_day_number());
+    }
+    if (patient_record.person.add_medicine(medicine_id, new_strength,
+                                           new_dosage))
+    {
+        patients_per_medicine_.at(medicine_id).insert(patient);
+        medicine_usage_.add(medicine_id);
+    }
+    record(Journal::ADD_MEDICINE, params);
+    out_ << MEDICINE_ADDED << patient_name << '\n';
 }
 // Remove chosen medicine from a Person* patient, if patient has
 // that medicine in use.
 void Hospital::remove_medicine(Params params)
 {
-    std::string medicine = params.at(0);
-    std::string patient = params.at(1);
-    std::map<std::string, Person*>::const_iterator
-            patient_iter = current_patients_.find(patient);
+    std::string_view medicine = params.at(0);
+    std::string_view patient_name = params.at(1);
 
     // Try finding a patient
-    if( patient_iter == current_patients_.end() )
+    Handle patient;
+    if( not find_current_patient(patient_name, patient) )
     {
-        std::cout << CANT_FIND << patient << std::endl;
+        ++errors_;
+        out_ << CANT_FIND << patient_name << '\n';
         return;
     }
 
-    // Remove medicine from a patient.
-    patient_iter->second->remove_medicine(medicine);
-    std::cout << MEDICINE_REMOVED << patient << std::endl;
+    // Remove medicine from a patient. Medicine nobody has ever used
+    // can't be removed.
+    Handle medicine_id;
+    PatientRecord& patient_record = *patients_.at(patient);
+    if (medicine_ids_.find(medicine, medicine_id) and
+        patient_record.person.remove_medicine(medicine_id))
+    {
+        patients_per_medicine_.at(medicine_id).erase(patient);
+        medicine_usage_.remove(medicine_id);
+        // Snapshots of the first version have no prescription history.
+        std::map<Handle, unsigned int>::iterator row =
+                patient_record.prescription_rows.find(medicine_id);
+        if (row != patient_record.prescription_rows.end())
+        {
+            prescriptions_.end(row->second, today_.get_day_number());
+            patient_record.prescription_rows.erase(row);
+        }
+    }
+    record(Journal::REMOVE_MEDICINE, params);
+    out_ << MEDICINE_REMOVED << patient_name << '\n';
 }
 
 // Used to print patient info, if patient info is found.
@@ -225,123 +328,360 @@ void Hospital::remove_medicine(Params params)
 // medicines currently in use.
 void Hospital::print_patient_info(Params params)
 {
-    std::string patient_name = params.at(0);
+    std::string_view patient_name = params.at(0);
 
-    if(care_periods_.find(patient_name) != care_periods_.end() )
+    Handle patient;
+    if (patient_ids_.find(patient_name, patient))
     {
-        for (CarePeriod* care_period : care_periods_.at(patient_name))
-        {
-            // Print care period info
-            care_period->print_date_info("* Care period: ");
-            care_period->print_staff("  - Staff: ");
-        }
-        std::cout << "* Medicines:";
-        alltime_patients_.at(patient_name)->print_medicines("  - ");
+        print_patient(patient);
         return;
     }
     // Patient can't be found.
-    std::cout << CANT_FIND << patient_name << std::endl;
+    ++errors_;
+    out_ << CANT_FIND << patient_name << '\n';
 }
 
 // Print care periods, where staff has been assigned to.
 // Prints start and end date of periods, as well as patient name.
 void Hospital::print_care_periods_per_staff(Params params)
 {
-    // Bool to know if staff has been assigned to any care period.
-    bool is_found = false;
+    std::string_view staff_name = params.at(0);
+    Handle staff_member;
+    if (not staff_ids_.find(staff_name, staff_member))
+    {
+        ++errors_;
+        out_ << CANT_FIND << staff_name << '\n';
+        return;
+    }
+    const std::vector<CarePeriod*>& staff_periods =
+            care_periods_per_staff_.at(staff_member);
+    if (staff_periods.empty())
+    {
+        out_ << "None" << '\n';
+        return;
+    }
+    for (CarePeriod* care_period : staff_periods)
+    {
+        care_period->print_date_info(out_, "");
+        out_ << "* Patient: "
+                  << patient_ids_.name(care_period->get_patient_id())
+                  << '\n';
+    }
+}
+// Print patients in the hospital on the given date.
+void Hospital::print_patients_on(Params params)
+{
+    unsigned int day = 0;
+    if (not to_day_number(params.at(0), day))
+    {
+        ++errors_;
+        out_ << NOT_NUMERIC << '\n';
+        return;
+    }
+    print_patients_in(day, day);
+}
 
-    std::string staff_name = params.at(0);
-    if (staff_.find(staff_name) != staff_.end() )
+// Run a print command in a hospital rebuilt from the history. Without
+// changes after the date the current state is used as such.
+void Hospital::print_as_of(std::string_view date, Report report,
+                           Params params)
+{
+    unsigned int day = 0;
+    if (not to_day_number(date, day))
     {
-        for (CarePeriod* care_period : care_periods_in_order_)
-        {
-            if (care_period->find_staff(staff_name))
-            {
-                care_period->print_date_info("");
-                std::cout << "* Patient: " << care_period->get_name() << std::endl;
-                is_found = true;
-            }
-        }
-        if (!is_found)
-        {
-            std::cout << "None" << std::endl;
-        }
+        ++errors_;
+        out_ << NOT_NUMERIC << '\n';
         return;
     }
-    std::cout << CANT_FIND << staff_name << std::endl;
+    if (history_ == nullptr)
+    {
+        ++errors_;
+        out_ << NO_HISTORY << '\n';
+        return;
+    }
+    if (history_->is_latest(day))
+    {
+        (this->*report)(params);
+        return;
+    }
+
+    Hospital view;
+    std::string text;
+    view.output().set_string(&text);
+    history_->rebuild(day, view);
+    (view.*report)(params);
+    view.output().flush();
+    out_ << text;
+    if (view.error_count() != 0)
+    {
+        ++errors_;
+    }
+}
+
+// Print patients in the hospital on some day between the given dates.
+void Hospital::print_patients_between(Params params)
+{
+    unsigned int first = 0;
+    unsigned int last = 0;
+    if (not to_day_number(params.at(0), first) or
+        not to_day_number(params.at(1), last))
+    {
+        ++errors_;
+        out_ << NOT_NUMERIC << '\n';
+        return;
+    }
+    if (last < first)
+    {
+        std::swap(first, last);
+    }
+    print_patients_in(first, last);
+}
+
+// Convert a ddmmyyyy parameter to a day number.
+bool Hospital::to_day_number(std::string_view date,
+                             unsigned int& day_number) const
+{
+    if (date.size() != 8 or not utils::is_numeric(date, false))
+    {
+        return false;
+    }
+    day_number = Date(std::string(date)).get_day_number();
+    return true;
 }
-// Used to create a set containing of all meds used by patients.
-std::set<std::string> Hospital::make_set_of_meds()
+
+// Print patients in alphabetical order, each followed by their care
+// periods overlapping the days in the order of start dates.
+void Hospital::print_patients_in(unsigned int first, unsigned int last)
 {
-    std::set<std::string> meds_set;
-    for (std::pair<std::string, Person*> patient_pair : alltime_patients_)
+    std::vector<CarePeriod*> care_periods;
+    care_period_index_.find(first, last, care_periods);
+    if (care_periods.empty())
     {
-        std::vector<std::string> meds = patient_pair.second->get_medicines();
-        for (std::string med : meds)
+        out_ << "None" << '\n';
+        return;
+    }
+    SymbolTable::ByName by_name{&patient_ids_};
+    std::stable_sort(care_periods.begin(), care_periods.end(),
+                     [by_name](CarePeriod* lhs, CarePeriod* rhs)
+                     { return by_name(lhs->get_patient_id(),
+                                      rhs->get_patient_id()); });
+    Handle previous = patient_ids_.size();
+    for (CarePeriod* care_period : care_periods)
+    {
+        if (care_period->get_patient_id() != previous)
         {
-            meds_set.insert(med);
+            previous = care_period->get_patient_id();
+            out_ << patient_ids_.name(previous) << '\n';
         }
+        care_period->print_date_info(out_, "* Care period: ");
     }
-    return meds_set;
 }
 
-void Hospital::print_all_medicines(Params)
+// Print the number of patients on the first of the given dates and on
+// every later day up to the last date on which the number changes.
+void Hospital::print_census(Params params)
 {
-    std::set<std::string> meds_set = make_set_of_meds();
-    if (meds_set.size() == 0)
+    unsigned int first = 0;
+    unsigned int last = 0;
+    if (not to_day_number(params.at(0), first) or
+        not to_day_number(params.at(1), last))
     {
-        std::cout << "None" << std::endl;
+        ++errors_;
+        out_ << NOT_NUMERIC << '\n';
         return;
     }
+    if (last < first)
+    {
+        std::swap(first, last);
+    }
+    std::vector<std::pair<unsigned int, unsigned long>> days;
+    census_.occupancy_changes(first, last, days);
+    Date date;
+    for (const std::pair<unsigned int, unsigned long>& day : days)
+    {
+        date.set_day_number(day.first);
+        date.print(out_);
+        out_ << ": " << day.second << '\n';
+    }
+}
 
-    for (std::string med_to_find : meds_set)
+// Print the number, average, median, 90th percentile and maximum of
+// lengths of closed care periods in days.
+void Hospital::print_los_stats(Params)
+{
+    unsigned long count = census_.closed_count();
+    if (count == 0)
     {
-        std::cout << med_to_find << " prescribed for" << std::endl;
+        out_ << "None" << '\n';
+        return;
+    }
+    // Average is rounded to one decimal.
+    unsigned long tenths = (census_.total_length() * 10 + count / 2) / count;
+    out_ << "Closed care periods: " << count << '\n'
+         << "Average length of stay: " << tenths / 10 << '.'
+         << static_cast<char>('0' + tenths % 10) << '\n'
+         << "Median length of stay: " << census_.length_percentile(50)
+         << '\n'
+         << "90th percentile length of stay: "
+         << census_.length_percentile(90) << '\n'
+         << "Longest stay: " << census_.length_percentile(100) << '\n';
+}
 
-        for (std::pair<std::string, Person*> pair : alltime_patients_)
+// Print all medicines in use and the patients using them.
+void Hospital::print_all_medicines(Params)
+{
+    bool is_found = false;
+    for (const SymbolTable::Entry& medicine_pair : medicine_ids_)
+    {
+        const std::set<Handle>& users =
+                patients_per_medicine_.at(medicine_pair.second);
+        if (users.empty())
         {
-            for (std::string med : pair.second->get_medicines())
-            {
-                if (med_to_find == med)
-                {
-                    std::cout << "* " << pair.second->get_id() << std::endl;
-                }
-            }
+            continue;
+        }
+        out_ << medicine_pair.first << " prescribed for" << '\n';
+        std::vector<Handle> patients(users.begin(), users.end());
+        patient_ids_.sort(patients);
+        for (Handle patient : patients)
+        {
+            out_ << "* " << patient_ids_.name(patient) << '\n';
         }
+        is_found = true;
+    }
+    if (not is_found)
+    {
+        out_ << "None" << '\n';
     }
 }
+// Print the prescriptions of a medicine in use on some day between the
+// given dates, each with its patient and the days it was in use.
+void Hospital::print_prescriptions(Params params)
+{
+    std::string_view medicine = params.at(0);
+    unsigned int first = 0;
+    unsigned int last = 0;
+    if (not to_day_number(params.at(1), first) or
+        not to_day_number(params.at(2), last))
+    {
+        ++errors_;
+        out_ << NOT_NUMERIC << '\n';
+        return;
+    }
+    Handle medicine_id;
+    if (not medicine_ids_.find(medicine, medicine_id))
+    {
+        ++errors_;
+        out_ << CANT_FIND << medicine << '\n';
+        return;
+    }
+    if (last < first)
+    {
+        std::swap(first, last);
+    }
+    std::vector<unsigned int> rows;
+    prescriptions_.find(medicine_id, first, last, rows);
+    if (rows.empty())
+    {
+        out_ << "None" << '\n';
+        return;
+    }
+    Date date;
+    for (unsigned int row : rows)
+    {
+        CarePeriod* care_period =
+                care_periods_in_order_.at(prescriptions_.care_period(row));
+        out_ << patient_ids_.name(care_period->get_patient_id()) << ": "
+             << prescriptions_.strength(row) << " mg x "
+             << prescriptions_.dosage(row) << ", ";
+        date.set_day_number(prescriptions_.start_day(row));
+        date.print(out_);
+        out_ << " -";
+        if (prescriptions_.end_day(row) != PrescriptionLog::OPEN_END)
+        {
+            out_ << ' ';
+            date.set_day_number(prescriptions_.end_day(row));
+            date.print(out_);
+        }
+        out_ << '\n';
+    }
+}
+
+// Print counts kept up to date by the changes, and the top of the staff
+// and medicines by their numbers of patients.
+void Hospital::print_summary(Params params)
+{
+    std::string_view amount = params.at(0);
+    if (not utils::is_numeric(amount, false))
+    {
+        ++errors_;
+        out_ << NOT_NUMERIC << '\n';
+        return;
+    }
+    // Every current patient has exactly one active care period.
+    out_ << "Staff: " << staff_.size() << '\n'
+         << "Patients: " << patients_.size() << ", current: "
+         << current_patients_.size() << '\n'
+         << "Care periods: " << care_periods_in_order_.size()
+         << ", active: " << current_patients_.size() << '\n'
+         << "Medicines in use: " << medicine_usage_.counted() << '\n';
+
+    std::vector<Handle> top;
+    staff_workload_.top(utils::to_number(amount), top);
+    out_ << "Staff with most current patients:";
+    print_tally(staff_workload_, top, staff_ids_);
+    medicine_usage_.top(utils::to_number(amount), top);
+    out_ << "Medicines with most patients:";
+    print_tally(medicine_usage_, top, medicine_ids_);
+}
+
+// Print the given handles with their counts, or None.
+void Hospital::print_tally(const Tally& tally, const std::vector<Handle>& top,
+                           const SymbolTable& names)
+{
+    if (top.empty())
+    {
+        out_ << " None" << '\n';
+        return;
+    }
+    out_ << '\n';
+    for (Handle handle : top)
+    {
+        out_ << "* " << names.name(handle) << ": " << tally.count(handle)
+             << '\n';
+    }
+}
+
 // Function to print all staff of hospital.
 void Hospital::print_all_staff(Params)
 {
     if( staff_.empty() )
     {
-        std::cout << "None" << std::endl;
+        out_ << "None" << '\n';
         return;
     }
-    for( std::map<std::string, Person*>::const_iterator iter = staff_.begin();
-         iter != staff_.end();
+    for( SymbolTable::const_iterator iter = staff_ids_.begin();
+         iter != staff_ids_.end();
          ++iter )
     {
-        std::cout << iter->first << std::endl;
+        out_ << iter->first << '\n';
     }
 }
 // Used to print info all current patients as well as patients
 // that have left the hospital.
 void Hospital::print_all_patients(Params)
 {
-    if (alltime_patients_.empty())
+    if (patients_.empty())
     {
-        std::cout << "None" << std::endl;
+        out_ << "None" << '\n';
         return;
     }
 
     // Go through all patients one by one.
-    for (std::pair<std::string, Person*> patient_pair : alltime_patients_)
+    for (const SymbolTable::Entry& patient_pair : patient_ids_)
     {
         // Print patient info.
-        std::cout << patient_pair.first << std::endl;
-        Params patient_as_param = {patient_pair.first};
-        print_patient_info(patient_as_param);
+        out_ << patient_pair.first << '\n';
+        print_patient(patient_pair.second);
     }
 }
 
@@ -352,46 +692,895 @@ void Hospital::print_current_patients(Params)
     // Check for empty container.
     if (current_patients_.empty())
     {
-        std::cout << "None" << std::endl;
+        out_ << "None" << '\n';
         return;
     }
-    for (std::pair<std::string, Person*> patient_pair : current_patients_)
+    std::vector<Handle> patients(current_patients_.begin(),
+                                 current_patients_.end());
+    patient_ids_.sort(patients);
+    for (Handle patient : patients)
+    {
+        out_ << patient_ids_.name(patient) << '\n';
+        print_patient(patient);
+    }
+}
+
+// Print all care periods and medicines of a patient.
+void Hospital::print_patient(Handle patient)
+{
+    const PatientRecord& patient_record = *patients_.at(patient);
+    for (CarePeriod* care_period : patient_record.care_periods)
+    {
+        // Print care period info
+        care_period->print_date_info(out_, "* Care period: ");
+        care_period->print_staff(out_, "  - Staff: ", staff_ids_);
+    }
+    out_ << "* Medicines:";
+    patient_record.person.print_medicines(out_, "  - ", medicine_ids_);
+}
+
+// Magic bytes and version at the beginning of a snapshot file. The version
+// must be increased whenever the format changes.
+const std::string SNAPSHOT_MAGIC = "HOSPSNAP";
+const std::uint32_t SNAPSHOT_VERSION = 2;
+
+// Size of a care period in a snapshot without its staff: patient, start,
+// end, whether active and the number of staff.
+const std::size_t CARE_PERIOD_MIN_SIZE = 4 + 4 + 4 + 1 + 4;
+
+// Snapshots of this version and later have the prescription history.
+const std::uint32_t FIRST_PRESCRIPTIONS_VERSION = 2;
+
+// Save the state of the hospital into a file.
+void Hospital::save_snapshot(Params params)
+{
+    std::string filename(params.at(0));
+    std::string data;
+    write_snapshot(data);
+    if (not utils::write_file(filename, data))
+    {
+        ++errors_;
+        out_ << SNAPSHOT_ERROR << filename << '\n';
+        return;
+    }
+    if (journal_ != nullptr and
+        not journal_->restart_from_snapshot(filename))
+    {
+        ++errors_;
+        out_ << JOURNAL_WRITE_ERROR << '\n';
+    }
+    out_ << SNAPSHOT_SAVED << filename << '\n';
+}
+
+// Replace the state of the hospital with the one in the file.
+void Hospital::load_snapshot(Params params)
+{
+    std::string filename(params.at(0));
+    std::string data;
+    // The snapshot is first read into a hospital of its own, so that a
+    // snapshot failing half way doesn't leave this hospital emptied.
+    Hospital loaded;
+    if (not utils::read_file(filename, data) or
+        not loaded.read_snapshot(data) or not read_snapshot(data))
+    {
+        ++errors_;
+        out_ << SNAPSHOT_ERROR << filename << '\n';
+        return;
+    }
+    ++version_;
+    if (history_ != nullptr)
+    {
+        history_->replace(today_.get_day_number(), *this);
+    }
+    if (journal_ != nullptr and
+        not journal_->restart_from_snapshot(filename))
+    {
+        ++errors_;
+        out_ << JOURNAL_WRITE_ERROR << '\n';
+    }
+    out_ << SNAPSHOT_LOADED << filename << '\n';
+}
+
+// Export everything as column files into a directory, which is created
+// if needed.
+void Hospital::export_tables(Params params)
+{
+    std::string directory(params.at(0));
+    if ((::mkdir(directory.c_str(), 0755) != 0 and errno != EEXIST) or
+        not write_export(directory))
+    {
+        ++errors_;
+        out_ << EXPORT_ERROR << directory << '\n';
+        return;
+    }
+    out_ << EXPORTED << directory << '\n';
+}
+
+// Export format: every column is a file of 32 bit little endian numbers
+// with one number per row, so a column can be mapped into memory as an
+// array. Rows of the files of a table correspond to each other.
+// - staff_names, patient_names, medicine_names: dictionaries of the names
+//   by handle. Column offsets has one more number than there are names,
+//   and name i is bytes offsets[i] .. offsets[i + 1] of file chars.
+// - care_periods: patient, start_day, end_day (4294967295 while active),
+//   in creation order
+// - staff_assignments: care_period (row in care_periods) and staff
+// - prescriptions: care_period, medicine, strength, dosage, start_day and
+//   end_day (4294967295 while in use), in the order they were started
+// Days are day numbers of Date, in which 1.1.0000 of the Gregorian
+// calendar is day 1. Each table is written in one
+// pass through a fixed buffer per column.
+bool Hospital::write_export(const std::string& directory) const
+{
+    std::string path = directory + '/';
+    if (not export_names(path + "staff_names.", staff_ids_) or
+        not export_names(path + "patient_names.", patient_ids_) or
+        not export_names(path + "medicine_names.", medicine_ids_))
+    {
+        return false;
+    }
+
+    ColumnFile patients;
+    ColumnFile start_days;
+    ColumnFile end_days;
+    ColumnFile assigned_care_periods;
+    ColumnFile assigned_staff;
+    patients.open(path + "care_periods.patient");
+    start_days.open(path + "care_periods.start_day");
+    end_days.open(path + "care_periods.end_day");
+    assigned_care_periods.open(path + "staff_assignments.care_period");
+    assigned_staff.open(path + "staff_assignments.staff");
+    for (CarePeriod* care_period : care_periods_in_order_)
+    {
+        patients.write_u32(care_period->get_patient_id());
+        start_days.write_u32(care_period->get_start_date().get_day_number());
+        end_days.write_u32(care_period->is_it_active()
+                           ? PrescriptionLog::OPEN_END
+                           : care_period->get_end_date().get_day_number());
+        for (const Handle* staff_member = care_period->staff_begin();
+             staff_member != care_period->staff_end(); ++staff_member)
+        {
+            assigned_care_periods.write_u32(care_period->get_number());
+            assigned_staff.write_u32(*staff_member);
+        }
+    }
+    bool is_written = patients.close();
+    is_written = start_days.close() and is_written;
+    is_written = end_days.close() and is_written;
+    is_written = assigned_care_periods.close() and is_written;
+    is_written = assigned_staff.close() and is_written;
+
+    using Column = unsigned int (PrescriptionLog::*)(unsigned int) const;
+    const std::pair<Column, const char*> columns[] = {
+        {&PrescriptionLog::care_period, "care_period"},
+        {&PrescriptionLog::medicine, "medicine"},
+        {&PrescriptionLog::strength, "strength"},
+        {&PrescriptionLog::dosage, "dosage"},
+        {&PrescriptionLog::start_day, "start_day"},
+        {&PrescriptionLog::end_day, "end_day"}};
+    const unsigned int COLUMN_COUNT = sizeof(columns) / sizeof(columns[0]);
+    ColumnFile files[COLUMN_COUNT];
+    for (unsigned int i = 0; i < COLUMN_COUNT; ++i)
+    {
+        files[i].open(path + "prescriptions." + columns[i].second);
+    }
+    for (unsigned int row = 0; row < prescriptions_.size(); ++row)
+    {
+        for (unsigned int i = 0; i < COLUMN_COUNT; ++i)
+        {
+            files[i].write_u32((prescriptions_.*columns[i].first)(row));
+        }
+    }
+    for (ColumnFile& file : files)
+    {
+        is_written = file.close() and is_written;
+    }
+    return is_written;
+}
+
+// Write the offsets and characters of the names in the order of handles.
+bool Hospital::export_names(const std::string& path,
+                            const SymbolTable& names)
+{
+    ColumnFile offsets;
+    ColumnFile chars;
+    offsets.open(path + "offsets");
+    chars.open(path + "chars");
+    std::uint32_t offset = 0;
+    offsets.write_u32(offset);
+    for (Handle handle = 0; handle < names.size(); ++handle)
+    {
+        const std::string& name = names.name(handle);
+        chars.write_bytes(name.data(), name.size());
+        offset += name.size();
+        offsets.write_u32(offset);
+    }
+    bool is_written = offsets.close();
+    return chars.close() and is_written;
+}
+
+// Snapshot format: magic, version, checksum of the contents and
+// the contents:
+// - current date
+// - names of staff, patients and medicines in the order of their handles
+// - for each patient: is the patient current and the medicines
+// - care periods in creation order with their staff
+// - prescription history column by column (since version 2)
+// Handles are stored as such, so the same names get the same handles
+// when loaded.
+void Hospital::write_snapshot(std::string& data) const
+{
+    BinaryWriter writer(data);
+    std::size_t checksum_position = start_snapshot(writer);
+
+    writer.write_u32(today_.get_day_number());
+    for (const SymbolTable* names : {&staff_ids_, &patient_ids_,
+                                     &medicine_ids_})
+    {
+        writer.write_u32(names->size());
+        for (Handle handle = 0; handle < names->size(); ++handle)
+        {
+            writer.write_string(names->name(handle));
+        }
+    }
+
+    for (const PatientRecord* patient_record : patients_)
+    {
+        write_patient(writer, *patient_record, nullptr);
+    }
+
+    writer.write_u32(care_periods_in_order_.size());
+    for (CarePeriod* care_period : care_periods_in_order_)
+    {
+        write_care_period(writer, care_period, care_period->get_patient_id());
+    }
+    write_prescriptions(writer, prescriptions_);
+    finish_snapshot(data, checksum_position);
+}
+
+// Write magic, version and room for the checksum.
+std::size_t Hospital::start_snapshot(BinaryWriter& writer)
+{
+    writer.write_bytes(SNAPSHOT_MAGIC.data(), SNAPSHOT_MAGIC.size());
+    writer.write_u32(SNAPSHOT_VERSION);
+    std::size_t checksum_position = writer.size();
+    writer.write_u64(0);
+    return checksum_position;
+}
+
+// Fill in the checksum of everything after it.
+void Hospital::finish_snapshot(std::string& data,
+                               std::size_t checksum_position)
+{
+    BinaryWriter writer(data);
+    std::size_t contents_position = checksum_position + 8;
+    std::uint64_t checksum = binaryio::checksum(data.data() + contents_position,
+                                                data.data() + data.size());
+    writer.patch_u32(checksum_position, checksum);
+    writer.patch_u32(checksum_position + 4, checksum >> 32);
+}
+
+// Write whether the patient is current and the prescriptions.
+void Hospital::write_patient(BinaryWriter& writer,
+                             const PatientRecord& patient_record,
+                             const std::vector<Handle>* medicine_handles)
+{
+    writer.write_u8(patient_record.is_current);
+    std::vector<Handle> medicines = patient_record.person.get_medicines();
+    writer.write_u32(medicines.size());
+    for (Handle medicine : medicines)
+    {
+        unsigned int strength = 0;
+        unsigned int dosage = 0;
+        patient_record.person.get_prescription(medicine, strength, dosage);
+        if (medicine_handles != nullptr)
+        {
+            medicine = medicine_handles->at(medicine);
+        }
+        writer.write_u32(medicine);
+        writer.write_u32(strength);
+        writer.write_u32(dosage);
+    }
+}
+
+// Write dates and staff of a care period.
+void Hospital::write_care_period(BinaryWriter& writer,
+                                 CarePeriod* care_period, Handle patient)
+{
+    writer.write_u32(patient);
+    writer.write_u32(care_period->get_start_date().get_day_number());
+    writer.write_u32(care_period->get_end_date().get_day_number());
+    writer.write_u8(care_period->is_it_active());
+    std::vector<Handle> staff = care_period->get_staff();
+    writer.write_u32(staff.size());
+    for (Handle staff_member : staff)
+    {
+        writer.write_u32(staff_member);
+    }
+}
+
+// Write the number of prescriptions and each column of them.
+void Hospital::write_prescriptions(BinaryWriter& writer,
+                                   const PrescriptionLog& prescriptions)
+{
+    using Column = unsigned int (PrescriptionLog::*)(unsigned int) const;
+    unsigned int count = prescriptions.size();
+    writer.write_u32(count);
+    for (Column column : {&PrescriptionLog::care_period,
+                          &PrescriptionLog::medicine,
+                          &PrescriptionLog::strength,
+                          &PrescriptionLog::dosage,
+                          &PrescriptionLog::start_day,
+                          &PrescriptionLog::end_day})
+    {
+        for (unsigned int row = 0; row < count; ++row)
+        {
+            writer.write_u32((prescriptions.*column)(row));
+        }
+    }
+}
+
+// Load a snapshot. The checksum is checked before anything is changed, so
+// a damaged file leaves the hospital as it was.
+bool Hospital::read_snapshot(const std::string& data)
+{
+    BinaryReader reader(data.data(), data.data() + data.size());
+    std::uint32_t version = 0;
+    std::uint64_t checksum = 0;
+    if (data.compare(0, SNAPSHOT_MAGIC.size(), SNAPSHOT_MAGIC) != 0 or
+        not reader.skip(SNAPSHOT_MAGIC.size()) or
+        not reader.read_u32(version) or version == 0 or
+        version > SNAPSHOT_VERSION or
+        not reader.read_u64(checksum) or
+        checksum != binaryio::checksum(reader.position(),
+                                       data.data() + data.size()))
+    {
+        return false;
+    }
+
+    clear();
+    bool is_valid = read_snapshot_contents(reader) and
+            (version < FIRST_PRESCRIPTIONS_VERSION or
+             read_prescriptions(reader)) and
+            reader.at_end();
+    if (not is_valid)
+    {
+        clear();
+    }
+    return is_valid;
+}
+
+// Read staff, patients and care periods of a snapshot. Objects are
+// allocated in bulk, because their numbers are known beforehand.
+bool Hospital::read_snapshot_contents(BinaryReader& reader)
+{
+    std::uint32_t today = 0;
+    reader.read_u32(today);
+    today_.set_day_number(today);
+
+    std::string name;
+    for (SymbolTable* names : {&staff_ids_, &patient_ids_, &medicine_ids_})
+    {
+        std::uint32_t count = 0;
+        reader.read_u32(count);
+        for (std::uint32_t handle = 0; handle < count; ++handle)
+        {
+            // Names must be unique to get the same handles again.
+            if (not reader.read_string(name) or names->intern(name) != handle)
+            {
+                return false;
+            }
+        }
+    }
+
+    persons_.reserve(staff_ids_.size());
+    staff_.reserve(staff_ids_.size());
+    for (Handle staff_member = 0; staff_member < staff_ids_.size();
+         ++staff_member)
     {
-        std::cout << patient_pair.first << std::endl;
-        Params patient = {patient_pair.first};
-        print_patient_info(patient);
+        staff_.push_back(persons_.create(staff_member));
+    }
+    care_periods_per_staff_.resize(staff_ids_.size());
+    patients_per_medicine_.resize(medicine_ids_.size());
+
+    patient_pool_.reserve(patient_ids_.size());
+    patients_.reserve(patient_ids_.size());
+    for (Handle patient = 0; patient < patient_ids_.size(); ++patient)
+    {
+        PatientRecord& patient_record = *patient_pool_.create(patient);
+    patients_.push_back(&patient_record);
+        std::uint8_t is_current = 0;
+        std::uint32_t medicine_count = 0;
+        reader.read_u8(is_current);
+        reader.read_u32(medicine_count);
+        patient_record.is_current = is_current != 0;
+        if (is_current)
+        {
+            current_patients_.insert(patient);
+        }
+        for (std::uint32_t i = 0; i < medicine_count; ++i)
+        {
+            std::uint32_t medicine = 0;
+            std::uint32_t strength = 0;
+            std::uint32_t dosage = 0;
+            reader.read_u32(medicine);
+            reader.read_u32(strength);
+            reader.read_u32(dosage);
+            if (medicine >= medicine_ids_.size())
+            {
+                return false;
+            }
+            patient_record.person.add_medicine(medicine, strength, dosage);
+            patients_per_medicine_.at(medicine).insert(patient);
+            medicine_usage_.add(medicine);
+        }
     }
+
+    std::uint32_t care_period_count = 0;
+    reader.read_u32(care_period_count);
+    // The care periods must be there before room is made for them.
+    BinaryReader rest = reader;
+    if (not rest.skip(std::size_t(care_period_count) * CARE_PERIOD_MIN_SIZE))
+    {
+        return false;
+    }
+    care_period_pool_.reserve(care_period_count);
+    care_periods_in_order_.reserve(care_period_count);
+    for (std::uint32_t i = 0; i < care_period_count and not reader.failed();
+         ++i)
+    {
+        std::uint32_t patient = 0;
+        std::uint32_t start = 0;
+        std::uint32_t end = 0;
+        std::uint8_t is_active = 0;
+        std::uint32_t staff_count = 0;
+        reader.read_u32(patient);
+        reader.read_u32(start);
+        reader.read_u32(end);
+        reader.read_u8(is_active);
+        reader.read_u32(staff_count);
+        if (patient >= patient_ids_.size())
+        {
+            return false;
+        }
+
+        PatientRecord& patient_record = *patients_.at(patient);
+        Date date;
+        date.set_day_number(start);
+        CarePeriod* care_period =
+                care_period_pool_.create(date, &patient_record.person, i);
+        date.set_day_number(end);
+        care_period->set_end_date(date);
+        if (not is_active)
+        {
+            care_period->set_careperiod_inactive();
+        }
+        care_periods_in_order_.push_back(care_period);
+        patient_record.care_periods.push_back(care_period);
+        care_period_index_.insert(start,
+                                  is_active ? IntervalIndex::OPEN_END : end,
+                                  care_period);
+        census_.admit(start);
+        if (not is_active)
+        {
+            census_.discharge(start, end);
+        }
+
+        for (std::uint32_t j = 0; j < staff_count; ++j)
+        {
+            std::uint32_t staff_member = 0;
+            reader.read_u32(staff_member);
+            if (staff_member >= staff_ids_.size())
+            {
+                return false;
+            }
+            care_period->add_staff(staff_member);
+            care_periods_per_staff_.at(staff_member).push_back(care_period);
+            if (is_active)
+            {
+                staff_workload_.add(staff_member);
+            }
+        }
+    }
+    return not reader.failed();
+}
+
+// Read the prescription history and find the prescriptions in use.
+bool Hospital::read_prescriptions(BinaryReader& reader)
+{
+    std::uint32_t count = 0;
+    reader.read_u32(count);
+    // The columns must be there before room is made for them.
+    BinaryReader rest = reader;
+    if (not rest.skip(std::size_t(count) * 6 * 4))
+    {
+        return false;
+    }
+    std::vector<std::uint32_t> columns(std::size_t(count) * 6);
+    for (std::uint32_t& value : columns)
+    {
+        reader.read_u32(value);
+    }
+    for (std::uint32_t row = 0; row < count; ++row)
+    {
+        std::uint32_t care_period = columns.at(row);
+        std::uint32_t medicine = columns.at(count + row);
+        if (care_period >= care_periods_in_order_.size() or
+            medicine >= medicine_ids_.size())
+        {
+            return false;
+        }
+        prescriptions_.add(care_period, medicine, columns.at(2 * count + row),
+                           columns.at(3 * count + row),
+                           columns.at(4 * count + row));
+        std::uint32_t end_day = columns.at(5 * count + row);
+        if (end_day == PrescriptionLog::OPEN_END)
+        {
+            Handle patient =
+                    care_periods_in_order_.at(care_period)->get_patient_id();
+            patients_.at(patient)->prescription_rows[medicine] = row;
+        }
+        else
+        {
+            prescriptions_.end(row, end_day);
+        }
+    }
+    return not reader.failed();
 }
+
+// Remove all staff, patients and care periods.
+void Hospital::clear()
+{
+    prescriptions_.clear();
+    care_periods_per_staff_.clear();
+    patients_per_medicine_.clear();
+    staff_workload_.clear();
+    medicine_usage_.clear();
+    care_periods_in_order_.clear();
+    care_period_index_.clear();
+    census_.clear();
+    current_patients_.clear();
+    patients_.clear();
+    staff_.clear();
+    staff_ids_.clear();
+    patient_ids_.clear();
+    medicine_ids_.clear();
+    care_period_pool_.clear();
+    patient_pool_.clear();
+    persons_.clear();
+}
+
+// Start recording changes into the given journal.
+void Hospital::set_journal(Journal* journal)
+{
+    journal_ = journal;
+}
+
+// Commit the pending group of the journal.
+void Hospital::commit_journal()
+{
+    if (journal_ != nullptr and not journal_->commit())
+    {
+        ++errors_;
+        out_ << JOURNAL_WRITE_ERROR << '\n';
+    }
+}
+
+// Start keeping history in the given event log.
+void Hospital::set_history(EventLog* history)
+{
+    history_ = history;
+}
+
+// Start appending changes into the given log.
+void Hospital::set_change_log(ChangeLog* changes)
+{
+    changes_ = changes;
+}
+
+// Record a successful change if changes are journaled, history is kept or
+// changes are appended to a log.
+void Hospital::record(Journal::Operation operation, Params params)
+{
+    ++version_;
+    if (journal_ != nullptr and not journal_->record(operation, params))
+    {
+        ++errors_;
+        out_ << JOURNAL_WRITE_ERROR << '\n';
+    }
+    // A log already missing changes stays behind, so that it is never taken
+    // for the whole state.
+    if (changes_ != nullptr and changes_->version + 1 == version_)
+    {
+        Journal::encode(operation, params, changes_->records);
+        changes_->version = version_;
+    }
+    if (history_ != nullptr)
+    {
+        history_->record(operation, params, today_.get_day_number(), *this);
+    }
+}
+
+// Writer for all output of the hospital.
+ReportWriter& Hospital::output()
+{
+    return out_;
+}
+
+// Number of commands failed so far.
+unsigned long Hospital::error_count() const
+{
+    return errors_;
+}
+
+// Number of changes made so far.
+unsigned long Hospital::version() const
+{
+    return version_;
+}
+
+// Whether changes are recorded into a journal.
+bool Hospital::is_journaled() const
+{
+    return journal_ != nullptr;
+}
+
+// Current date as a day number.
+unsigned int Hospital::day_number() const
+{
+    return today_.get_day_number();
+}
+
+// Add a change of a replay shard to the history. No checkpoint is taken,
+// because this hospital is not yet in the state after the change; loading
+// the merged state takes one.
+void Hospital::record_replayed(Journal::Operation operation, Params params,
+                               unsigned int day)
+{
+    if (history_ != nullptr)
+    {
+        history_->append(operation, params, day);
+    }
+}
+
+// Shard of a patient by the hash of the name.
+unsigned int Hospital::shard_of(std::string_view patient_name,
+                                unsigned int shards)
+{
+    return std::hash<std::string_view>()(patient_name) % shards;
+}
+
+// Give the position to everything not yet in the order.
+void Hospital::update_replay_order(ReplayOrder& order,
+                                   unsigned long position) const
+{
+    order.patients.resize(patients_.size(), position);
+    order.medicines.resize(medicine_ids_.size(), position);
+    order.care_periods.resize(care_periods_in_order_.size(), position);
+    order.prescriptions.resize(prescriptions_.size(), position);
+}
+
+// Merge the shards by writing their state as a single snapshot and loading
+// it. Patients, medicines and care periods are sorted by the positions
+// where they were created. Whatever this hospital had before is in every
+// shard at position 0 with its old handle, but only the shard of its
+// patient has the latest state of it. The same goes for prescriptions by
+// the patient of their care period.
+bool Hospital::merge_shards(const std::vector<Hospital*>& shards,
+                            const std::vector<ReplayOrder>& orders)
+{
+    // Position, handle (or number of care period) and shard.
+    using Key = std::tuple<unsigned long, unsigned int, unsigned int>;
+    unsigned int shard_count = shards.size();
+
+    std::vector<Key> patients;
+    std::vector<Key> care_periods;
+    std::vector<Key> prescriptions;
+    std::unordered_map<std::string_view, std::pair<unsigned long, Handle>>
+            medicines;
+    for (unsigned int i = 0; i < shard_count; ++i)
+    {
+        const Hospital& shard = *shards.at(i);
+        const ReplayOrder& order = orders.at(i);
+        for (Handle patient = 0; patient < shard.patients_.size(); ++patient)
+        {
+            if (shard_of(shard.patient_ids_.name(patient), shard_count) == i)
+            {
+                patients.emplace_back(order.patients.at(patient), patient, i);
+            }
+        }
+        for (unsigned int j = 0; j < shard.care_periods_in_order_.size(); ++j)
+        {
+            Handle patient = shard.care_periods_in_order_.at(j)
+                    ->get_patient_id();
+            if (shard_of(shard.patient_ids_.name(patient), shard_count) == i)
+            {
+                care_periods.emplace_back(order.care_periods.at(j), j, i);
+            }
+        }
+        for (unsigned int row = 0; row < shard.prescriptions_.size(); ++row)
+        {
+            Handle patient = shard.care_periods_in_order_.at(
+                        shard.prescriptions_.care_period(row))
+                    ->get_patient_id();
+            if (shard_of(shard.patient_ids_.name(patient), shard_count) == i)
+            {
+                prescriptions.emplace_back(order.prescriptions.at(row), row,
+                                           i);
+            }
+        }
+        // The same medicine may be new in several shards, the first use
+        // gives its handle.
+        for (Handle medicine = 0; medicine < shard.medicine_ids_.size();
+             ++medicine)
+        {
+            std::pair<unsigned long, Handle> first(
+                        order.medicines.at(medicine), medicine);
+            std::pair<std::unordered_map<std::string_view,
+                    std::pair<unsigned long, Handle>>::iterator, bool>
+                    inserted = medicines.insert(
+                        {shard.medicine_ids_.name(medicine), first});
+            if (not inserted.second and first < inserted.first->second)
+            {
+                inserted.first->second = first;
+            }
+        }
+    }
+    std::sort(patients.begin(), patients.end());
+    std::sort(care_periods.begin(), care_periods.end());
+    std::sort(prescriptions.begin(), prescriptions.end());
+    std::vector<std::pair<std::pair<unsigned long, Handle>, std::string_view>>
+            medicine_order;
+    for (const auto& medicine : medicines)
+    {
+        medicine_order.push_back({medicine.second, medicine.first});
+    }
+    std::sort(medicine_order.begin(), medicine_order.end());
+
+    // New handles of the patients and medicines of each shard.
+    std::vector<std::vector<Handle>> patient_handles(shard_count);
+    std::vector<std::vector<Handle>> medicine_handles(shard_count);
+    std::vector<std::vector<unsigned int>> care_period_numbers(shard_count);
+    for (unsigned int i = 0; i < shard_count; ++i)
+    {
+        patient_handles.at(i).resize(shards.at(i)->patients_.size());
+        medicine_handles.at(i).resize(shards.at(i)->medicine_ids_.size());
+        care_period_numbers.at(i).resize(
+                    shards.at(i)->care_periods_in_order_.size());
+    }
+    for (Handle patient = 0; patient < patients.size(); ++patient)
+    {
+        patient_handles.at(std::get<2>(patients.at(patient)))
+                .at(std::get<1>(patients.at(patient))) = patient;
+    }
+    for (unsigned int number = 0; number < care_periods.size(); ++number)
+    {
+        care_period_numbers.at(std::get<2>(care_periods.at(number)))
+                .at(std::get<1>(care_periods.at(number))) = number;
+    }
+    for (unsigned int i = 0; i < shard_count; ++i)
+    {
+        const SymbolTable& names = shards.at(i)->medicine_ids_;
+        for (Handle medicine = 0; medicine < medicine_order.size();
+             ++medicine)
+        {
+            Handle old_medicine;
+            if (names.find(medicine_order.at(medicine).second, old_medicine))
+            {
+                medicine_handles.at(i).at(old_medicine) = medicine;
+            }
+        }
+    }
+
+    // Dates and staff are the same in every shard.
+    const Hospital& first_shard = *shards.at(0);
+    std::string data;
+    BinaryWriter writer(data);
+    std::size_t checksum_position = start_snapshot(writer);
+    writer.write_u32(first_shard.today_.get_day_number());
+    writer.write_u32(first_shard.staff_ids_.size());
+    for (Handle staff_member = 0; staff_member < first_shard.staff_ids_.size();
+         ++staff_member)
+    {
+        writer.write_string(first_shard.staff_ids_.name(staff_member));
+    }
+    writer.write_u32(patients.size());
+    for (const Key& patient : patients)
+    {
+        writer.write_string(shards.at(std::get<2>(patient))
+                            ->patient_ids_.name(std::get<1>(patient)));
+    }
+    writer.write_u32(medicine_order.size());
+    for (const auto& medicine : medicine_order)
+    {
+        writer.write_string(std::string(medicine.second));
+    }
+    for (const Key& patient : patients)
+    {
+        unsigned int i = std::get<2>(patient);
+        write_patient(writer,
+                      *shards.at(i)->patients_.at(std::get<1>(patient)),
+                      &medicine_handles.at(i));
+    }
+    writer.write_u32(care_periods.size());
+    for (const Key& key : care_periods)
+    {
+        unsigned int i = std::get<2>(key);
+        CarePeriod* care_period =
+                shards.at(i)->care_periods_in_order_.at(std::get<1>(key));
+        write_care_period(writer, care_period,
+                          patient_handles.at(i).at(
+                              care_period->get_patient_id()));
+    }
+    PrescriptionLog merged_prescriptions;
+    for (const Key& key : prescriptions)
+    {
+        unsigned int i = std::get<2>(key);
+        unsigned int row = std::get<1>(key);
+        const PrescriptionLog& log = shards.at(i)->prescriptions_;
+        unsigned int new_row = merged_prescriptions.add(
+                    care_period_numbers.at(i).at(log.care_period(row)),
+                    medicine_handles.at(i).at(log.medicine(row)),
+                    log.strength(row), log.dosage(row), log.start_day(row));
+        merged_prescriptions.end(new_row, log.end_day(row));
+    }
+    write_prescriptions(writer, merged_prescriptions);
+    finish_snapshot(data, checksum_position);
+
+    if (not read_snapshot(data))
+    {
+        return false;
+    }
+    ++version_;
+    return true;
+}
+
 // Function to set date.
 void Hospital::set_date(Params params)
 {
-    std::string day = params.at(0);
-    std::string month = params.at(1);
-    std::string year = params.at(2);
+    std::string_view day = params.at(0);
+    std::string_view month = params.at(1);
+    std::string_view year = params.at(2);
     if( not utils::is_numeric(day, false) or
         not utils::is_numeric(month, false) or
         not utils::is_numeric(year, false) )
     {
-        std::cout << NOT_NUMERIC << std::endl;
+        ++errors_;
+        out_ << NOT_NUMERIC << '\n';
         return;
     }
-    utils::today.set(stoi(day), stoi(month), stoi(year));
-    std::cout << "Date has been set to ";
-    utils::today.print();
-    std::cout << std::endl;
+    // A date too far in the future can't be stored.
+    if( not today_.set(utils::to_number(day), utils::to_number(month),
+                       utils::to_number(year)) )
+    {
+        ++errors_;
+        out_ << NOT_NUMERIC << '\n';
+        return;
+    }
+    record(Journal::SET_DATE, params);
+    out_ << "Date has been set to ";
+    today_.print(out_);
+    out_ << '\n';
 }
 // Function to advance date. Goes forward in days by chosen
 // amount.
 void Hospital::advance_date(Params params)
 {
-    std::string amount = params.at(0);
+    std::string_view amount = params.at(0);
     if( not utils::is_numeric(amount, true) )
     {
-        std::cout << NOT_NUMERIC << std::endl;
+        ++errors_;
+        out_ << NOT_NUMERIC << '\n';
+        return;
+    }
+    if( not today_.advance(utils::to_number(amount)) )
+    {
+        ++errors_;
+        out_ << NOT_NUMERIC << '\n';
         return;
     }
-    utils::today.advance(stoi(amount));
-    std::cout << "New date is ";
-    utils::today.print();
-    std::cout << std::endl;
+    record(Journal::ADVANCE_DATE, params);
+    out_ << "New date is ";
+    today_.print(out_);
+    out_ << '\n';
 }
@@ -12,7 +12,20 @@
 #include "person.hh"
 #include "careperiod.hh"
 #include "date.hh"
+#include "binaryio.hh"
+#include "census.hh"
+#include "eventlog.hh"
+#include "intervalindex.hh"
+#include "journal.hh"
+#include "objectpool.hh"
+#include "prescriptionlog.hh"
+#include "reportwriter.hh"
+#include "symboltable.hh"
+#include "tally.hh"
 #include <map>
+#include <set>
+#include <string_view>
+#include <vector>
 
 // Error and information outputs
 const std::string ALREADY_EXISTS = "Error: Already exists: ";
@@ -24,8 +37,21 @@ const std::string PATIENT_LEFT = "Patient left hospital, care period closed.";
 const std::string MEDICINE_ADDED= "Medicine added for: ";
 const std::string MEDICINE_REMOVED= "Medicine removed from: ";
 const std::string STAFF_ASSIGNED= "Staff assigned for: ";
+const std::string SNAPSHOT_SAVED = "Snapshot saved to: ";
+const std::string SNAPSHOT_LOADED = "Snapshot loaded from: ";
+const std::string SNAPSHOT_ERROR = "Error: Can't use snapshot file: ";
+const std::string NO_HISTORY = "Error: No history kept.";
+const std::string JOURNAL_WRITE_ERROR = "Error: Can't write journal file.";
+const std::string EXPORTED = "Exported to: ";
+const std::string EXPORT_ERROR = "Error: Can't export to: ";
 
-using Params = const std::vector<std::string>&;
+// Parameters of a command, pointing into the command line.
+using Params = const std::vector<std::string_view>&;
+
+class Hospital;
+
+// Print command of the hospital.
+using Report = void (Hospital::*)(Params params);
 
 class Hospital
 {
@@ -47,14 +73,14 @@ public:
 
     // Adds a previously existed patient back to current patients. Creates
     // a new care period for a patient.
-    void re_enter_patient(std::string patient_name);
+    void re_enter_patient(Handle patient);
 
     // Adds a new patient in the hospital. Also adds a new care period for a
     // new patient.
-    void enter_new_patient(std::string patient_name);
+    void enter_new_patient(std::string_view patient_name);
 
-    // Adds a patient to alltime patients.
-    void add_alltime_patient(std::string patient_name, Person* new_patient);
+    // Creates a new care period for the given patient starting today.
+    CarePeriod* new_care_period(Person* patient);
 
     // Removes the person given as a parameter from the hospital, and closes
     // person's care period.
@@ -88,8 +114,34 @@ public:
     // care periods the given staff member has worked in.
     void print_care_periods_per_staff(Params params);
 
-    // Creates a set of all meds currently used by patients.
-    std::set<std::string> make_set_of_meds();
+    // Prints the patients who were in the hospital on the given date
+    // (ddmmyyyy) and their care periods covering the date.
+    void print_patients_on(Params params);
+
+    // Prints the patients who were in the hospital on some day between the
+    // given dates (ddmmyyyy), both included, and their care periods
+    // overlapping the dates.
+    void print_patients_between(Params params);
+
+    // Prints the number of patients in the hospital on each day between
+    // the given dates (ddmmyyyy).
+    void print_census(Params params);
+
+    // Prints statistics of the lengths of closed care periods.
+    void print_los_stats(Params);
+
+    // Prints all prescriptions of the given medicine in use on some day
+    // between the given dates (ddmmyyyy), in the order they were started.
+    void print_prescriptions(Params params);
+
+    // Prints the numbers of staff, patients, care periods and medicines in
+    // use, and the given number of staff members with the most current
+    // patients and medicines with the most patients.
+    void print_summary(Params params);
+
+    // Runs the given print command against the state of the hospital at
+    // the end of the given date (ddmmyyyy), rebuilt from its history.
+    void print_as_of(std::string_view date, Report report, Params params);
 
     // Prints all medicines that are used by some patient visited the hospital
     // at some time, i.e. all medicines of current and earlier patients.
@@ -115,24 +167,265 @@ public:
     // Advances the current date with the given number of days.
     void advance_date(Params params);
 
+    // Saves the whole state of the hospital (staff, patients, care periods,
+    // medicines and the current date) into the given file.
+    void save_snapshot(Params params);
+
+    // Replaces the state of the hospital with the one saved in the given
+    // file.
+    void load_snapshot(Params params);
+
+    // Writes names, care periods, staff assignments and prescriptions into
+    // the given directory as column files for other programs to read.
+    void export_tables(Params params);
+
+    // Appends the state of the hospital in the binary snapshot format to
+    // the given string.
+    void write_snapshot(std::string& data) const;
+
+    // Replaces the state of the hospital with the given snapshot data.
+    // Returns false if the data is not a valid snapshot, in which case the
+    // hospital is left empty. Nothing is recorded into the history, see
+    // load_snapshot.
+    bool read_snapshot(const std::string& data);
+
+    // Makes the hospital record all successful changes into the given
+    // journal. Null pointer stops recording.
+    void set_journal(Journal* journal);
+
+    // Writes the changes recorded so far into the journal and syncs it to
+    // disk. Called before waiting for input, so that no change already
+    // reported done waits for the next one. Prints an error if the changes
+    // can't be written; they are written again by the next commit.
+    void commit_journal();
+
+    // Makes the hospital keep its history in the given event log, so that
+    // print_as_of can be used. Null pointer stops recording.
+    void set_history(EventLog* history);
 
+    // Changes encoded like journal records (see Journal::encode) and the
+    // version of the hospital after the last of them.
+    struct ChangeLog
+    {
+        std::string records;
+        unsigned long version;
+    };
+
+    // Makes the hospital append all successful changes into the given log,
+    // whose version must be the current one. Changes not made by single
+    // commands (loading a snapshot, merging replay shards) can't be
+    // appended, after them the version of the log stays behind the version
+    // of the hospital. Null pointer stops appending.
+    void set_change_log(ChangeLog* changes);
+
+    // Returns the writer all output of the hospital goes through.
+    ReportWriter& output();
+
+    // Returns the number of commands that have failed, e.g. because of
+    // unknown ids or non-numeric parameters.
+    unsigned long error_count() const;
+
+    // Returns the version of the state of the hospital. The version changes
+    // whenever the state changes, so equal versions mean equal states.
+    unsigned long version() const;
+
+    // Returns true if changes are recorded into a journal.
+    bool is_journaled() const;
+
+    // Returns the current date as a day number.
+    unsigned int day_number() const;
+
+    // Adds a change run in a replay shard on the given day to the history,
+    // if history is kept. The changes must be added in the order of the log
+    // before the shards are merged.
+    void record_replayed(Journal::Operation operation, Params params,
+                         unsigned int day);
+
+    // Positions in a replayed log of the commands that created the
+    // patients, medicines and care periods of a shard (see ParallelReplay),
+    // indexed by handles and creation order. Whatever the shard had before
+    // the replay is at position 0.
+    struct ReplayOrder
+    {
+        std::vector<unsigned long> patients;
+        std::vector<unsigned long> medicines;
+        std::vector<unsigned long> care_periods;
+        std::vector<unsigned long> prescriptions;
+    };
+
+    // Returns the shard of the given patient, when patients are divided
+    // between the given number of shards.
+    static unsigned int shard_of(std::string_view patient_name,
+                                 unsigned int shards);
+
+    // Records the given position for the patients, medicines and care
+    // periods created after the order was updated the last time.
+    void update_replay_order(ReplayOrder& order, unsigned long position) const;
+
+    // Replaces the state of the hospital with the merged state of the given
+    // shards. Every shard must have started from the state of this hospital
+    // and run the commands of its own patients (see shard_of) and all
+    // commands of staff and dates. Handles and care periods are numbered in
+    // the order of the positions of the commands that created them, as in
+    // a serial run. Returns false if the result is not a valid state, in
+    // which case the hospital is left empty. Nothing is recorded into the
+    // history: the commands of the shards are recorded with
+    // record_replayed instead.
+    bool merge_shards(const std::vector<Hospital*>& shards,
+                      const std::vector<ReplayOrder>& orders);
 
 private:
-    // Container for all the staff current patients.
-    std::map<std::string, Person*> current_patients_;
+    // Storage of staff Person objects and all CarePeriod objects of the
+    // hospital. The containers below only point to these objects. Patient
+    // records are pooled the same way, see patient_pool_.
+    ObjectPool<Person> persons_;
+    ObjectPool<CarePeriod> care_period_pool_;
+
+    // Handles of all names used in the hospital. The containers below
+    // are indexed by these handles.
+    SymbolTable staff_ids_;
+    SymbolTable patient_ids_;
+    SymbolTable medicine_ids_;
 
     // Container for all the current staff.
-    std::map<std::string, Person*> staff_;
+    std::vector<Person*> staff_;
+
+    // Everything about a patient who has visited the hospital: the person
+    // (id and medicines), all care periods of the patient in creation
+    // order, the last one being the current or latest one, and whether the
+    // patient is currently in the hospital.
+    struct PatientRecord
+    {
+        explicit PatientRecord(Handle patient);
+
+        Person person;
+        std::vector<CarePeriod*> care_periods;
+        bool is_current;
+
+        // Rows of the current prescriptions in the prescription log, by
+        // medicine.
+        std::map<Handle, unsigned int> prescription_rows;
+    };
 
-    // Container for all the care periods.
-    std::map<std::string, std::vector<CarePeriod*>> care_periods_;
+    // Storage of the records of all visited patients. Records keep their
+    // addresses, so care periods can point to the persons.
+    ObjectPool<PatientRecord> patient_pool_;
 
-    // Container for all visited patients.
-    std::map<std::string, Person*> alltime_patients_;
+    // Records of all visited patients, indexed by their handles.
+    std::vector<PatientRecord*> patients_;
+
+    // Container for all the current patients, sorted by name only when
+    // printed.
+    std::set<Handle> current_patients_;
 
     // Container for all CarePeriods by time added. (
     // first earliest, last latest)
     std::vector<CarePeriod*> care_periods_in_order_;
+
+    // Care periods each staff member has worked in, in the same order
+    // as in care_periods_in_order_.
+    std::vector<std::vector<CarePeriod*>> care_periods_per_staff_;
+
+    // Care periods by the days they cover.
+    IntervalIndex care_period_index_;
+
+    // Numbers of patients by day and lengths of stay.
+    Census census_;
+
+    // History of all prescriptions.
+    PrescriptionLog prescriptions_;
+
+    // Patients using each medicine, sorted by name only when printed.
+    std::vector<std::set<Handle>> patients_per_medicine_;
+
+    // Current patients of each staff member (of the active care periods
+    // they are assigned to) and patients using each medicine, counted as
+    // they change.
+    Tally staff_workload_;
+    Tally medicine_usage_;
+
+    // Current date of the hospital.
+    Date today_;
+
+    // Number of failed commands.
+    unsigned long errors_;
+
+    // Number of changes made, see version().
+    unsigned long version_;
+
+    // Buffered output of all commands.
+    ReportWriter out_;
+
+    // Journal of changes, or null if changes are not recorded.
+    Journal* journal_;
+
+    // History of changes, or null if history is not kept.
+    EventLog* history_;
+
+    // Log of changes, or null if changes are not appended to a log.
+    ChangeLog* changes_;
+
+    // Records a successful change into the journal, the history and the
+    // change log and updates the version. Called after the change has been
+    // made.
+    void record(Journal::Operation operation, Params params);
+
+    // Prints care periods and medicines of a patient
+    // (the format of print_patient_info).
+    void print_patient(Handle patient);
+
+    // Removes all staff, patients and care periods.
+    void clear();
+
+    // Converts a date parameter (ddmmyyyy) to a day number. Returns false
+    // if the parameter is not a date.
+    bool to_day_number(std::string_view date, unsigned int& day_number) const;
+
+    // Prints the patients whose care periods overlap the given days.
+    void print_patients_in(unsigned int first, unsigned int last);
+
+    // Writes the header of a snapshot. Returns the position of the
+    // checksum, which finish_snapshot fills in.
+    static std::size_t start_snapshot(BinaryWriter& writer);
+    static void finish_snapshot(std::string& data,
+                                std::size_t checksum_position);
+
+    // Writes a patient of a snapshot, with the medicines renumbered by the
+    // given vector if it is not null.
+    static void write_patient(BinaryWriter& writer,
+                              const PatientRecord& patient_record,
+                              const std::vector<Handle>* medicine_handles);
+
+    // Writes a care period of a snapshot for the given patient handle.
+    static void write_care_period(BinaryWriter& writer,
+                                  CarePeriod* care_period, Handle patient);
+
+    // Prints the given handles of a tally with their counts.
+    void print_tally(const Tally& tally, const std::vector<Handle>& top,
+                     const SymbolTable& names);
+
+    // Writes all column files of an export into the directory.
+    bool write_export(const std::string& directory) const;
+
+    // Writes the names of a symbol table as an export dictionary whose
+    // files start with the given path.
+    static bool export_names(const std::string& path,
+                             const SymbolTable& names);
+
+    // Writes the prescription log of a snapshot column by column.
+    static void write_prescriptions(BinaryWriter& writer,
+                                    const PrescriptionLog& prescriptions);
+
+    // Reads the snapshot contents after the header.
+    bool read_snapshot_contents(BinaryReader& reader);
+
+    // Reads the prescription log of a snapshot after the care periods.
+    bool read_prescriptions(BinaryReader& reader);
+
+    // Finds a patient who is currently in the hospital. Returns false if
+    // the patient can't be found.
+    bool find_current_patient(std::string_view patient_name,
+                              Handle& patient) const;
 };
 
 #endif // HOSPITAL_HH
@@ -1,5 +1,5 @@
 TEMPLATE = app
-CONFIG += console c++11
+CONFIG += console c++17 thread
 CONFIG -= app_bundle
 CONFIG -= qt
 
@@ -10,7 +10,19 @@ SOURCES += \
     careperiod.cpp \
     hospital.cpp \
     cli.cpp \
-    utils.cpp
+    utils.cpp \
+    symboltable.cpp \
+    reportwriter.cpp \
+    binaryio.cpp \
+    journal.cpp \
+    reportrunner.cpp \
+    intervalindex.cpp \
+    census.cpp \
+    latencyhistogram.cpp \
+    parallelreplay.cpp \
+    eventlog.cpp \
+    prescriptionlog.cpp \
+    tally.cpp
 
 HEADERS += \
     person.hh \
@@ -18,4 +30,18 @@ HEADERS += \
     careperiod.hh \
     hospital.hh \
     cli.hh \
-    utils.hh
+    utils.hh \
+    objectpool.hh \
+    smallset.hh \
+    symboltable.hh \
+    reportwriter.hh \
+    binaryio.hh \
+    journal.hh \
+    reportrunner.hh \
+    intervalindex.hh \
+    census.hh \
+    latencyhistogram.hh \
+    parallelreplay.hh \
+    eventlog.hh \
+    prescriptionlog.hh \
+    tally.hh
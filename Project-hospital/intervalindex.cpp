@@ -0,0 +1,154 @@
+#include "intervalindex.hh"
+
+IntervalIndex::IntervalIndex():
+    root_(nullptr), seed_(2463534242u)
+{
+}
+
+void IntervalIndex::insert(unsigned int start, unsigned int end,
+                           CarePeriod* period)
+{
+    Node* added = nodes_.create(Node{start, end, end, next_priority(), period,
+                                     nullptr, nullptr});
+    root_ = insert(root_, added);
+}
+
+void IntervalIndex::set_end(unsigned int start, CarePeriod* period,
+                            unsigned int end)
+{
+    set_end(root_, start, period, end);
+}
+
+void IntervalIndex::find(unsigned int first, unsigned int last,
+                         std::vector<CarePeriod*>& result) const
+{
+    find(root_, first, last, result);
+}
+
+void IntervalIndex::clear()
+{
+    nodes_.clear();
+    root_ = nullptr;
+}
+
+bool IntervalIndex::is_before(unsigned int start, const CarePeriod* period,
+                              const Node* node)
+{
+    if ( start != node->start )
+    {
+        return start < node->start;
+    }
+    return period->get_number() < node->period->get_number();
+}
+
+void IntervalIndex::update(Node* node)
+{
+    node->max_end = node->end;
+    if ( node->left != nullptr and node->left->max_end > node->max_end )
+    {
+        node->max_end = node->left->max_end;
+    }
+    if ( node->right != nullptr and node->right->max_end > node->max_end )
+    {
+        node->max_end = node->right->max_end;
+    }
+}
+
+IntervalIndex::Node* IntervalIndex::rotate_left(Node* node)
+{
+    Node* right = node->right;
+    node->right = right->left;
+    right->left = node;
+    update(node);
+    update(right);
+    return right;
+}
+
+IntervalIndex::Node* IntervalIndex::rotate_right(Node* node)
+{
+    Node* left = node->left;
+    node->left = left->right;
+    left->right = node;
+    update(node);
+    update(left);
+    return left;
+}
+
+IntervalIndex::Node* IntervalIndex::insert(Node* node, Node* added)
+{
+    if ( node == nullptr )
+    {
+        return added;
+    }
+    // Nodes with higher priorities are moved above their parents.
+    if ( is_before(added->start, added->period, node) )
+    {
+        node->left = insert(node->left, added);
+        if ( node->left->priority > node->priority )
+        {
+            return rotate_right(node);
+        }
+    }
+    else
+    {
+        node->right = insert(node->right, added);
+        if ( node->right->priority > node->priority )
+        {
+            return rotate_left(node);
+        }
+    }
+    update(node);
+    return node;
+}
+
+void IntervalIndex::set_end(Node* node, unsigned int start,
+                            const CarePeriod* period, unsigned int end)
+{
+    if ( node == nullptr )
+    {
+        return;
+    }
+    if ( node->period == period )
+    {
+        node->end = end;
+    }
+    else if ( is_before(start, period, node) )
+    {
+        set_end(node->left, start, period, end);
+    }
+    else
+    {
+        set_end(node->right, start, period, end);
+    }
+    update(node);
+}
+
+void IntervalIndex::find(const Node* node, unsigned int first,
+                         unsigned int last, std::vector<CarePeriod*>& result)
+{
+    // No period in the subtree lasts until the first day.
+    if ( node == nullptr or node->max_end < first )
+    {
+        return;
+    }
+    find(node->left, first, last, result);
+    // Periods from here on the right start too late.
+    if ( node->start > last )
+    {
+        return;
+    }
+    if ( node->end >= first )
+    {
+        result.push_back(node->period);
+    }
+    find(node->right, first, last, result);
+}
+
+unsigned int IntervalIndex::next_priority()
+{
+    // Xorshift generator.
+    seed_ ^= seed_ << 13;
+    seed_ ^= seed_ >> 17;
+    seed_ ^= seed_ << 5;
+    return seed_;
+}
@@ -0,0 +1,89 @@
+/* Class IntervalIndex
+ * ----------
+ * COMP.CS.110 SPRING 2021
+ * ----------
+ * Class for finding the care periods that overlap a range of days. Care
+ * periods are kept in a balanced search tree (a treap) ordered by their
+ * start days. Every node also knows the latest end day in its subtree, so
+ * subtrees without overlapping periods are skipped. Finding takes
+ * logarithmic time plus time for each period found.
+ *
+ * Days are day numbers of dates. Periods still active end at OPEN_END.
+ * */
+#ifndef INTERVALINDEX_HH
+#define INTERVALINDEX_HH
+
+#include "careperiod.hh"
+#include "objectpool.hh"
+#include <limits>
+#include <vector>
+
+class IntervalIndex
+{
+public:
+    // End day of periods that have not ended.
+    static constexpr unsigned int OPEN_END =
+            std::numeric_limits<unsigned int>::max();
+
+    // Constructor.
+    IntervalIndex();
+
+    IntervalIndex(const IntervalIndex&) = delete;
+    IntervalIndex& operator=(const IntervalIndex&) = delete;
+
+    // Adds the given care period lasting from start to end.
+    void insert(unsigned int start, unsigned int end, CarePeriod* period);
+
+    // Changes the end day of a care period added earlier with the given
+    // start day.
+    void set_end(unsigned int start, CarePeriod* period, unsigned int end);
+
+    // Appends the care periods that overlap days first..last (both
+    // included) to result, in the order of their start days.
+    void find(unsigned int first, unsigned int last,
+              std::vector<CarePeriod*>& result) const;
+
+    // Removes all care periods.
+    void clear();
+
+private:
+    struct Node
+    {
+        unsigned int start;
+        unsigned int end;
+        // Latest end day in the subtree of the node.
+        unsigned int max_end;
+        unsigned int priority;
+        CarePeriod* period;
+        Node* left;
+        Node* right;
+    };
+
+    ObjectPool<Node> nodes_;
+    Node* root_;
+
+    // State of the pseudo-random generator of node priorities.
+    unsigned int seed_;
+
+    // Order of nodes: by start days, then by creation order of periods.
+    static bool is_before(unsigned int start, const CarePeriod* period,
+                          const Node* node);
+
+    // Recalculates max_end of the node from its children.
+    static void update(Node* node);
+
+    // Rotations that keep the order of nodes.
+    static Node* rotate_left(Node* node);
+    static Node* rotate_right(Node* node);
+
+    // Recursive helpers, return the new root of the subtree.
+    Node* insert(Node* node, Node* added);
+    static void set_end(Node* node, unsigned int start,
+                        const CarePeriod* period, unsigned int end);
+    static void find(const Node* node, unsigned int first, unsigned int last,
+                     std::vector<CarePeriod*>& result);
+
+    unsigned int next_priority();
+};
+
+#endif // INTERVALINDEX_HH
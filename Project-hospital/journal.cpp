@@ -0,0 +1,326 @@
+#include "journal.hh"
+#include "binaryio.hh"
+#include "hospital.hh"
+#include "utils.hh"
+#include <fcntl.h>
+#include <unistd.h>
+
+// Magic bytes and version at the beginning of a journal file.
+const std::string JOURNAL_MAGIC = "HOSPJRNL";
+const std::uint32_t JOURNAL_VERSION = 1;
+const std::size_t JOURNAL_HEADER_SIZE = 12;
+
+// Each group of records is preceded by its size and checksum, so that a
+// group only partly written before a crash can be detected and dropped.
+const std::size_t GROUP_HEADER_SIZE = 12;
+
+const std::chrono::milliseconds Journal::GROUP_TIME(100);
+
+// Kinds of the parameters of each operation in the order of the Operation
+// enum: s is a string and n a number.
+const std::string PARAMETER_KINDS[] = { "", "s", "s", "s", "ss", "snns", "ss",
+                                        "nnn", "n", "s" };
+
+// Hospital commands replaying each operation.
+using Mutator = void (Hospital::*)(Params params);
+const Mutator MUTATORS[] = { nullptr, &Hospital::recruit, &Hospital::enter,
+                             &Hospital::leave, &Hospital::assign_staff,
+                             &Hospital::add_medicine,
+                             &Hospital::remove_medicine, &Hospital::set_date,
+                             &Hospital::advance_date,
+                             &Hospital::load_snapshot };
+
+// Writes the magic bytes and version of a journal file to the data.
+static void write_header(std::string& data)
+{
+    BinaryWriter writer(data);
+    writer.write_bytes(JOURNAL_MAGIC.data(), JOURNAL_MAGIC.size());
+    writer.write_u32(JOURNAL_VERSION);
+}
+
+// Writes the size and checksum of the records following the room left for
+// them at the beginning of the group.
+static void seal_group(std::string& group)
+{
+    BinaryWriter writer(group);
+    writer.patch_u32(0, group.size() - GROUP_HEADER_SIZE);
+    std::uint64_t checksum =
+            binaryio::checksum(group.data() + GROUP_HEADER_SIZE,
+                               group.data() + group.size());
+    writer.patch_u32(4, checksum);
+    writer.patch_u32(8, checksum >> 32);
+}
+
+Journal::Journal():
+    fd_(-1), pending_count_(0), recovered_count_(0)
+{
+}
+
+Journal::~Journal()
+{
+    commit();
+    if ( fd_ >= 0 )
+    {
+        ::close(fd_);
+    }
+}
+
+bool Journal::open(const std::string& filename, bool recover,
+                   Hospital& hospital)
+{
+    std::size_t valid_size = 0;
+    std::string data;
+    if ( recover and utils::read_file(filename, data) and not data.empty() )
+    {
+        if ( data.compare(0, JOURNAL_MAGIC.size(), JOURNAL_MAGIC) != 0 )
+        {
+            return false;
+        }
+        valid_size = replay(data, hospital);
+        if ( valid_size == 0 )
+        {
+            return false;
+        }
+    }
+
+    filename_ = filename;
+    fd_ = ::open(filename.c_str(), O_WRONLY | O_CREAT, 0644);
+    if ( fd_ < 0 )
+    {
+        return false;
+    }
+    // A group left partly written is cut away before appending.
+    if ( ::ftruncate(fd_, valid_size) != 0 or
+         ::lseek(fd_, valid_size, SEEK_SET) < 0 )
+    {
+        return false;
+    }
+    if ( valid_size == 0 )
+    {
+        std::string header;
+        write_header(header);
+        if ( not utils::write_all(fd_, header) or ::fdatasync(fd_) != 0 )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+unsigned long Journal::recovered_count() const
+{
+    return recovered_count_;
+}
+
+bool Journal::record(Operation operation,
+                     const std::vector<std::string_view>& params)
+{
+    // Records are kept pending even if the file was lost after an error,
+    // so that every later commit fails too.
+    if ( filename_.empty() )
+    {
+        return true;
+    }
+    std::chrono::steady_clock::time_point now =
+            std::chrono::steady_clock::now();
+    if ( pending_count_ == 0 )
+    {
+        // Leave room for the group header.
+        pending_.assign(GROUP_HEADER_SIZE, '\0');
+        first_pending_ = now;
+    }
+
+    encode(operation, params, pending_);
+    ++pending_count_;
+
+    if ( pending_count_ >= GROUP_SIZE or now - first_pending_ >= GROUP_TIME )
+    {
+        return commit();
+    }
+    return true;
+}
+
+bool Journal::commit()
+{
+    if ( pending_count_ == 0 )
+    {
+        return true;
+    }
+    if ( fd_ < 0 )
+    {
+        return false;
+    }
+    seal_group(pending_);
+    off_t size = ::lseek(fd_, 0, SEEK_CUR);
+    if ( size >= 0 and utils::write_all(fd_, pending_) and
+         ::fdatasync(fd_) == 0 )
+    {
+        pending_.clear();
+        pending_count_ = 0;
+        return true;
+    }
+    // A group partly written is cut away, so that the group can be written
+    // again. If that fails too, nothing can be appended after it, since
+    // recovery stops at the broken group.
+    if ( size < 0 or ::ftruncate(fd_, size) != 0 or
+         ::lseek(fd_, size, SEEK_SET) < 0 )
+    {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    return false;
+}
+
+bool Journal::restart_from_snapshot(const std::string& snapshot_filename)
+{
+    if ( filename_.empty() )
+    {
+        return true;
+    }
+    // The record is first appended, so the journal recovers the same state
+    // even if it can't be replaced below.
+    record(LOAD_SNAPSHOT, {snapshot_filename});
+    bool is_committed = commit();
+
+    // The journal is replaced by a new file with the record alone. Renaming
+    // it into place leaves either the old or the new journal after a crash,
+    // never an empty one.
+    std::string data;
+    write_header(data);
+    std::string group(GROUP_HEADER_SIZE, '\0');
+    encode(LOAD_SNAPSHOT, {snapshot_filename}, group);
+    seal_group(group);
+    data += group;
+    if ( not utils::write_file(filename_, data) )
+    {
+        return is_committed;
+    }
+    // The new journal holds everything that was still pending.
+    pending_.clear();
+    pending_count_ = 0;
+    if ( fd_ >= 0 )
+    {
+        ::close(fd_);
+    }
+    fd_ = ::open(filename_.c_str(), O_WRONLY);
+    if ( fd_ >= 0 and ::lseek(fd_, 0, SEEK_END) < 0 )
+    {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    return fd_ >= 0;
+}
+
+std::size_t Journal::replay(const std::string& data, Hospital& hospital)
+{
+    BinaryReader reader(data.data(), data.data() + data.size());
+    std::uint32_t version = 0;
+    if ( not reader.skip(JOURNAL_MAGIC.size()) or
+         not reader.read_u32(version) or version != JOURNAL_VERSION )
+    {
+        return 0;
+    }
+
+    // Output of the replayed commands is not wanted.
+    ReportWriter& out = hospital.output();
+    bool was_discarding = out.is_discarding();
+    out.set_discard(true);
+
+    // Parameters are read into values and passed on as views of them.
+    std::vector<std::string> values;
+    std::vector<std::string_view> params;
+    std::size_t valid_size = JOURNAL_HEADER_SIZE;
+    unsigned long errors = hospital.error_count();
+    while ( not reader.at_end() )
+    {
+        std::uint32_t group_size = 0;
+        std::uint64_t checksum = 0;
+        if ( not reader.read_u32(group_size) or
+             not reader.read_u64(checksum) )
+        {
+            break;
+        }
+        const char* group = reader.position();
+        if ( not reader.skip(group_size) or
+             checksum != binaryio::checksum(group, group + group_size) )
+        {
+            break;
+        }
+
+        BinaryReader records(group, group + group_size);
+        while ( not records.at_end() and
+                run_record(records, hospital, values, params) )
+        {
+            // Only successful changes are recorded, so a failing record
+            // (e.g. a snapshot file that can't be loaded any more) means
+            // the state can't be recovered.
+            if ( hospital.error_count() != errors )
+            {
+                out.set_discard(was_discarding);
+                return 0;
+            }
+            ++recovered_count_;
+        }
+        valid_size = reader.position() - data.data();
+    }
+
+    out.set_discard(was_discarding);
+    return valid_size;
+}
+
+void Journal::encode(Operation operation,
+                     const std::vector<std::string_view>& params,
+                     std::string& data)
+{
+    BinaryWriter writer(data);
+    writer.write_u8(operation);
+    const std::string& kinds = PARAMETER_KINDS[operation];
+    for ( unsigned int i = 0; i < kinds.size(); ++i )
+    {
+        if ( kinds.at(i) == 'n' )
+        {
+            writer.write_varint(utils::to_number(params.at(i)));
+        }
+        else
+        {
+            writer.write_varint(params.at(i).size());
+            writer.write_bytes(params.at(i).data(), params.at(i).size());
+        }
+    }
+}
+
+bool Journal::run_record(BinaryReader& records, Hospital& hospital,
+                         std::vector<std::string>& values,
+                         std::vector<std::string_view>& params)
+{
+    std::uint8_t operation = 0;
+    records.read_u8(operation);
+    if ( records.failed() or operation < RECRUIT or
+         operation > LOAD_SNAPSHOT )
+    {
+        return false;
+    }
+    const std::string& kinds = PARAMETER_KINDS[operation];
+    values.resize(kinds.size());
+    params.clear();
+    for ( unsigned int i = 0; i < kinds.size(); ++i )
+    {
+        std::uint32_t value = 0;
+        records.read_varint(value);
+        if ( kinds.at(i) == 'n' )
+        {
+            values.at(i) = std::to_string(value);
+        }
+        else
+        {
+            records.read_bytes(value, values.at(i));
+        }
+        params.push_back(values.at(i));
+    }
+    if ( records.failed() )
+    {
+        return false;
+    }
+    (hospital.*MUTATORS[operation])(params);
+    return true;
+}
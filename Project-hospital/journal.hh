@@ -0,0 +1,115 @@
+/* Class Journal
+ * ----------
+ * COMP.CS.110 SPRING 2021
+ * ----------
+ * Class for an append-only journal of the commands that changed the state
+ * of the hospital. Every successful change is recorded as a compact binary
+ * record. Records are written to the file in groups, and the file is synced
+ * to disk once per group, not once per command. The program also commits
+ * the group before it waits for input, so a group is only kept open while
+ * commands are running back to back. After a crash the state can be
+ * recovered by replaying the journal straight into a hospital.
+ *
+ * When a snapshot is saved or loaded, the journal is replaced with a
+ * single record that loads the snapshot, so the journal never grows longer
+ * than the changes made after the latest snapshot. Recovery fails if the
+ * snapshot can't be loaded.
+ * */
+#ifndef JOURNAL_HH
+#define JOURNAL_HH
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class BinaryReader;
+class Hospital;
+
+class Journal
+{
+public:
+    // Operations recorded in the journal.
+    enum Operation
+    {
+        RECRUIT = 1,
+        ENTER,
+        LEAVE,
+        ASSIGN_STAFF,
+        ADD_MEDICINE,
+        REMOVE_MEDICINE,
+        SET_DATE,
+        ADVANCE_DATE,
+        LOAD_SNAPSHOT
+    };
+
+    // Constructor.
+    Journal();
+
+    // Destructor, commits the records not yet written.
+    ~Journal();
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    // Opens the given journal file for appending. If recover is true, the
+    // records already in the file are first replayed into the given
+    // hospital, otherwise the file is started anew. Returns false if the
+    // file can't be used or its records can't be replayed.
+    bool open(const std::string& filename, bool recover, Hospital& hospital);
+
+    // Returns the number of records replayed when the journal was opened.
+    unsigned long recovered_count() const;
+
+    // Adds a record of a successful operation with the parameters given
+    // to the hospital command. The record is written when its group is
+    // committed. Returns false if the group was committed and failed.
+    bool record(Operation operation,
+                const std::vector<std::string_view>& params);
+
+    // Writes all pending records to the file and syncs it to disk. Returns
+    // false if they can't be written, in which case they stay pending and
+    // are written again by the next commit.
+    bool commit();
+
+    // Restarts the journal with a record that loads the given snapshot file.
+    // Returns false if the record can't be written.
+    bool restart_from_snapshot(const std::string& snapshot_filename);
+
+    // Appends a record of the given operation to the data, in the format
+    // of the journal file.
+    static void encode(Operation operation,
+                       const std::vector<std::string_view>& params,
+                       std::string& data);
+
+    // Reads a record written by encode and runs it in the hospital. The
+    // parameters are read into values and passed on as views of them.
+    // Returns false if there is no valid record to read.
+    static bool run_record(BinaryReader& records, Hospital& hospital,
+                           std::vector<std::string>& values,
+                           std::vector<std::string_view>& params);
+
+private:
+    // A group is committed when it has this many records, or when a new
+    // record arrives this long after the first pending one.
+    static const unsigned int GROUP_SIZE = 256;
+    static const std::chrono::milliseconds GROUP_TIME;
+
+    std::string filename_;
+    int fd_;
+
+    // Records not yet written and their number.
+    std::string pending_;
+    unsigned int pending_count_;
+    std::chrono::steady_clock::time_point first_pending_;
+
+    unsigned long recovered_count_;
+
+    // Replays the records of the given journal data into the hospital.
+    // Returns the size of the valid part of the data, or zero if a record
+    // fails to run.
+    std::size_t replay(const std::string& data, Hospital& hospital);
+};
+
+#endif // JOURNAL_HH
@@ -0,0 +1,75 @@
+#include "latencyhistogram.hh"
+
+LatencyHistogram::LatencyHistogram():
+    count_(0), longest_(0)
+{
+}
+
+void LatencyHistogram::record(unsigned long nanoseconds)
+{
+    if ( buckets_.empty() )
+    {
+        buckets_.resize(bucket(~0ul) + 1, 0);
+    }
+    ++buckets_.at(bucket(nanoseconds));
+    ++count_;
+    if ( nanoseconds > longest_ )
+    {
+        longest_ = nanoseconds;
+    }
+}
+
+unsigned long LatencyHistogram::count() const
+{
+    return count_;
+}
+
+unsigned long LatencyHistogram::percentile(unsigned int percent) const
+{
+    unsigned long needed = (count_ * percent + 99) / 100;
+    unsigned long counted = 0;
+    for ( unsigned int i = 0; i < buckets_.size(); ++i )
+    {
+        counted += buckets_.at(i);
+        if ( counted >= needed and counted > 0 )
+        {
+            unsigned long limit = upper_limit(i);
+            return limit < longest_ ? limit : longest_;
+        }
+    }
+    return 0;
+}
+
+unsigned long LatencyHistogram::longest() const
+{
+    return longest_;
+}
+
+unsigned int LatencyHistogram::bucket(unsigned long nanoseconds)
+{
+    // Small times have buckets of their own.
+    if ( nanoseconds < SUB_BUCKETS )
+    {
+        return nanoseconds;
+    }
+    // Position of the highest bit, and the bits after it pick the bucket.
+    unsigned int high_bit = 0;
+    for ( unsigned long rest = nanoseconds; rest > 1; rest >>= 1 )
+    {
+        ++high_bit;
+    }
+    unsigned int shift = high_bit - SUB_BUCKET_BITS;
+    unsigned int sub_bucket = (nanoseconds >> shift) - SUB_BUCKETS;
+    return (shift + 1) * SUB_BUCKETS + sub_bucket;
+}
+
+unsigned long LatencyHistogram::upper_limit(unsigned int bucket)
+{
+    if ( bucket < SUB_BUCKETS )
+    {
+        return bucket;
+    }
+    unsigned int shift = bucket / SUB_BUCKETS - 1;
+    unsigned long sub_bucket = bucket % SUB_BUCKETS;
+    return ((SUB_BUCKETS + sub_bucket + 1) << shift) - 1;
+}
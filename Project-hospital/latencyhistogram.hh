@@ -0,0 +1,52 @@
+/* Class LatencyHistogram
+ * ----------
+ * COMP.CS.110 SPRING 2021
+ * ----------
+ * Class for counting how long commands take. Times are counted in buckets
+ * whose sizes grow exponentially: every power of two is split into four
+ * buckets, so a percentile read from the buckets is at most 25 % too
+ * large. The longest time is kept exactly. The buckets are allocated only
+ * when the first time is recorded.
+ * */
+#ifndef LATENCYHISTOGRAM_HH
+#define LATENCYHISTOGRAM_HH
+
+#include <vector>
+
+class LatencyHistogram
+{
+public:
+    // Constructor.
+    LatencyHistogram();
+
+    // Records a time in nanoseconds.
+    void record(unsigned long nanoseconds);
+
+    // Returns the number of times recorded.
+    unsigned long count() const;
+
+    // Returns a time that the given percentage of the recorded times do
+    // not exceed, i.e. the upper limit of the bucket where the percentile
+    // falls, but never more than the longest time.
+    unsigned long percentile(unsigned int percent) const;
+
+    // Returns the longest time recorded.
+    unsigned long longest() const;
+
+private:
+    // Number of buckets per power of two, as a power of two.
+    static const unsigned int SUB_BUCKET_BITS = 2;
+    static const unsigned int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+
+    // Numbers of times in each bucket.
+    std::vector<unsigned long> buckets_;
+    unsigned long count_;
+    unsigned long longest_;
+
+    // Returns the bucket of the given time and the largest time in the
+    // given bucket.
+    static unsigned int bucket(unsigned long nanoseconds);
+    static unsigned long upper_limit(unsigned int bucket);
+};
+
+#endif // LATENCYHISTOGRAM_HH
@@ -1,6 +1,10 @@
 #include "cli.hh"
 #include "hospital.hh"
+#include "eventlog.hh"
+#include "journal.hh"
+#include <iostream>
 #include <string>
+#include <unistd.h>
 
 /* Hospital program
  *
@@ -23,26 +27,155 @@
  * add_medicine {medicine name} {strength} {dosage} {patient id} add medicine to a patient.
  * remove_medicine {medicine name} {patient id} remove medicine from patient
  * print_patient_info {patient id} Prints patient's info (Careperiods, medicines)
+ * print_patients_on {date} print patients in hospital on the date (ddmmyyyy)
+ * print_patients_between {date} {date} print patients in hospital between the dates
+ * census {date} {date} print the number of patients on each day between the dates
+ * los_stats print statistics of lengths of closed care periods in days
+ * summary {amount} print counts of the hospital and the given number of
+ * busiest staff members and most used medicines.
  * print_care_periods {staff member id} print care periods per staff
+ * print_prescriptions {medicine name} {date} {date} print the prescriptions
+ * of the medicine in use between the dates.
  * print_all_medicines Print all used medicines
  * print_all_staff, Print all staff
  * print_all_patients, print all patients
  * print_current patients, print current patients
  * set_date, set date {day} {month} {year} sets wanted date.
  * advance_date {days} advances date for a chosen amount.
+ * save_snapshot {filename} saves the whole state of the hospital into a binary file.
+ * load_snapshot {filename} replaces the state of the hospital with a saved one.
+ * export {directory} writes care periods, staff assignments, prescriptions
+ * and names into the directory as column files for analysis tools.
  * read_from {filename} read input commands from a file.
+ * batch {filename} run commands from a file without output, prints number of
+ * commands, errors and time used. batch_verbose {filename} also prints output.
+ * replay {filename} runs a file of changes like batch, divided between
+ * threads by patients.
+ * background_reports {on/off} run print commands on a worker thread against
+ * the state of the hospital when they were given, so changes can go on.
+ * stats, prints the number of calls and times of commands (with --stats).
+ * as_of {date} {print command} {params}, runs the print command against the
+ * state of the hospital at the end of the date (ddmmyyyy) (with --history).
  * help, prints all commands
  * Quit, quits program
+ *
+ * Command line options:
+ * --direct-output  write output of the commands straight to the standard
+ *                  output file descriptor instead of std::cout.
+ * --journal {file} record all changes into the given journal file.
+ *                  Without --recover the journal is started anew.
+ * --recover        replay the changes in the journal file before starting.
+ * --background-reports  run print commands in the background from the
+ *                  start, like the command background_reports on.
+ * --history        keep the history of all changes in memory for as_of.
+ * --stats          record the number of calls and times of commands, and
+ *                  print them to the standard error output when quitting.
+ * --pipe           run the commands of the standard input without prompts,
+ *                  like a verbose batch file, for scripted use. Exit status
+ *                  is failure if any command failed.
 */
 const std::string PROMPT = "Hosp> ";
+const std::string DIRECT_OUTPUT = "--direct-output";
+const std::string JOURNAL = "--journal";
+const std::string RECOVER = "--recover";
+const std::string BACKGROUND_REPORTS = "--background-reports";
+const std::string HISTORY = "--history";
+const std::string STATS = "--stats";
+const std::string PIPE = "--pipe";
+const std::string JOURNAL_ERROR = "Error: Can't use journal file: ";
+const std::string JOURNAL_RECOVERED = "Commands recovered from journal: ";
 
 
-int main()
+int main(int argc, char* argv[])
 {
     Hospital* hospital = new Hospital();
+    std::string journal_file = "";
+    bool recover = false;
+    bool background_reports = false;
+    bool keep_history = false;
+    bool stats = false;
+    bool pipe = false;
+    for ( int i = 1; i < argc; ++i )
+    {
+        if ( argv[i] == DIRECT_OUTPUT )
+        {
+            hospital->output().set_file_descriptor(STDOUT_FILENO);
+        }
+        else if ( argv[i] == JOURNAL and i + 1 < argc )
+        {
+            journal_file = argv[++i];
+        }
+        else if ( argv[i] == RECOVER )
+        {
+            recover = true;
+        }
+        else if ( argv[i] == BACKGROUND_REPORTS )
+        {
+            background_reports = true;
+        }
+        else if ( argv[i] == HISTORY )
+        {
+            keep_history = true;
+        }
+        else if ( argv[i] == STATS )
+        {
+            stats = true;
+        }
+        else if ( argv[i] == PIPE )
+        {
+            pipe = true;
+        }
+    }
+
+    // History is kept from the start, so recovered changes are in it too.
+    // It costs memory and time on every change, so only as_of needs it.
+    EventLog history;
+    if ( keep_history )
+    {
+        hospital->set_history(&history);
+    }
+
+    Journal journal;
+    if ( journal_file != "" )
+    {
+        if ( not journal.open(journal_file, recover, *hospital) )
+        {
+            std::cout << JOURNAL_ERROR << journal_file << std::endl;
+            delete hospital;
+            return EXIT_FAILURE;
+        }
+        if ( recover )
+        {
+            std::cout << JOURNAL_RECOVERED << journal.recovered_count()
+                      << std::endl;
+        }
+        hospital->set_journal(&journal);
+    }
+
     Cli cli(hospital, PROMPT);
-    while ( cli.exec() ){}
+    cli.set_background_reports(background_reports);
+    cli.set_statistics(stats);
+    bool succeeded = true;
+    if ( pipe )
+    {
+        succeeded = cli.exec_pipe();
+    }
+    else
+    {
+        while ( cli.exec() ){}
+    }
+    // Changes still pending are committed while a failure can be reported.
+    unsigned long errors = hospital->error_count();
+    hospital->commit_journal();
+    hospital->output().flush();
+    succeeded = succeeded and hospital->error_count() == errors;
+    if ( stats )
+    {
+        ReportWriter errors;
+        errors.set_file_descriptor(STDERR_FILENO);
+        cli.print_statistics(errors);
+    }
 
     delete hospital;
-    return EXIT_SUCCESS;
+    return succeeded ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -0,0 +1,147 @@
+/* Class ObjectPool
+ * ----------
+ * COMP.CS.110 SPRING 2021
+ * ----------
+ * Class template for allocating objects of one type from large slabs
+ * instead of creating each of them separately with new. Objects keep their
+ * address until the pool is destroyed, so pointers to them can be stored
+ * freely. Single objects are never released, all of them are destroyed
+ * and released at once when the pool is destroyed. Objects owning nothing
+ * (trivially destructible, like the nodes of IntervalIndex) are released
+ * one slab at a time without going through them. Other objects, like
+ * Person and CarePeriod, are still destroyed one by one along with what
+ * they own (e.g. the medicines of a Person), the pool only saves their
+ * separate allocations and deletes.
+ * */
+#ifndef OBJECTPOOL_HH
+#define OBJECTPOOL_HH
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+template <typename T>
+class ObjectPool
+{
+public:
+    // Constructor.
+    ObjectPool();
+
+    // Destructor. Destroys all objects created from the pool and releases
+    // the slabs, one delete per slab. Destructors are run only for types
+    // that need them.
+    ~ObjectPool();
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    // Creates a new object from the pool with the given constructor
+    // parameters.
+    template <typename... Args>
+    T* create(Args&&... args);
+
+    // Makes room for at least count more objects in a single slab.
+    void reserve(std::size_t count);
+
+    // Returns the number of objects created from the pool.
+    std::size_t size() const;
+
+    // Destroys all objects created from the pool and releases the slabs.
+    void clear();
+
+private:
+    // Default number of objects in one slab.
+    static const std::size_t SLAB_SIZE = 1024;
+
+    struct Slab
+    {
+        T* objects;
+        std::size_t capacity;
+        std::size_t used;
+    };
+
+    // Slabs in allocation order, objects are created in the last one.
+    std::vector<Slab> slabs_;
+
+    // Number of objects created.
+    std::size_t size_;
+
+    // Allocates a new slab for the given number of objects.
+    void add_slab(std::size_t capacity);
+};
+
+template <typename T>
+ObjectPool<T>::ObjectPool():
+    size_(0)
+{
+}
+
+template <typename T>
+ObjectPool<T>::~ObjectPool()
+{
+    clear();
+}
+
+template <typename T>
+void ObjectPool<T>::clear()
+{
+    for ( Slab& slab : slabs_ )
+    {
+        if ( not std::is_trivially_destructible<T>::value )
+        {
+            for ( std::size_t i = 0; i < slab.used; ++i )
+            {
+                slab.objects[i].~T();
+            }
+        }
+        ::operator delete(slab.objects);
+    }
+    slabs_.clear();
+    size_ = 0;
+}
+
+template <typename T>
+template <typename... Args>
+T* ObjectPool<T>::create(Args&&... args)
+{
+    if ( slabs_.empty() or slabs_.back().used == slabs_.back().capacity )
+    {
+        add_slab(SLAB_SIZE);
+    }
+    Slab& slab = slabs_.back();
+    T* object = new (slab.objects + slab.used) T(std::forward<Args>(args)...);
+    ++slab.used;
+    ++size_;
+    return object;
+}
+
+template <typename T>
+void ObjectPool<T>::reserve(std::size_t count)
+{
+    if ( not slabs_.empty() and
+         slabs_.back().capacity - slabs_.back().used >= count )
+    {
+        return;
+    }
+    add_slab(count < SLAB_SIZE ? SLAB_SIZE : count);
+}
+
+template <typename T>
+std::size_t ObjectPool<T>::size() const
+{
+    return size_;
+}
+
+template <typename T>
+void ObjectPool<T>::add_slab(std::size_t capacity)
+{
+    Slab slab;
+    slab.objects = static_cast<T*>(::operator new(capacity * sizeof(T)));
+    slab.capacity = capacity;
+    slab.used = 0;
+    slabs_.push_back(slab);
+}
+
+#endif // OBJECTPOOL_HH
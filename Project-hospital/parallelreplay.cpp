@@ -0,0 +1,182 @@
+#include "parallelreplay.hh"
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <thread>
+
+ParallelReplay::ParallelReplay(unsigned int shards):
+    shards_(shards > 0 ? shards : 1),
+    size_(0)
+{
+}
+
+bool ParallelReplay::add(Change change, Params params)
+{
+    // Which parameter names the patient, if the command has one.
+    unsigned int patient_param = 0;
+    Journal::Operation operation = Journal::RECRUIT;
+    if ( change == &Hospital::enter )
+    {
+        operation = Journal::ENTER;
+    }
+    else if ( change == &Hospital::leave )
+    {
+        operation = Journal::LEAVE;
+    }
+    else if ( change == &Hospital::assign_staff )
+    {
+        patient_param = 1;
+        operation = Journal::ASSIGN_STAFF;
+    }
+    else if ( change == &Hospital::remove_medicine )
+    {
+        patient_param = 1;
+        operation = Journal::REMOVE_MEDICINE;
+    }
+    else if ( change == &Hospital::add_medicine )
+    {
+        patient_param = 3;
+        operation = Journal::ADD_MEDICINE;
+    }
+    else if ( change == &Hospital::set_date )
+    {
+        operation = Journal::SET_DATE;
+    }
+    else if ( change == &Hospital::advance_date )
+    {
+        operation = Journal::ADVANCE_DATE;
+    }
+    else if ( change != &Hospital::recruit )
+    {
+        return false;
+    }
+
+    ++size_;
+    Command command = {change, operation, size_, params_.size(),
+                       params.size(), true};
+    params_.insert(params_.end(), params.begin(), params.end());
+    if ( change == &Hospital::recruit or change == &Hospital::set_date or
+         change == &Hospital::advance_date )
+    {
+        for ( std::vector<Command>& shard : shards_ )
+        {
+            shard.push_back(command);
+            command.counts_errors = false;
+        }
+        return true;
+    }
+    unsigned int shard = Hospital::shard_of(params.at(patient_param),
+                                            shards_.size());
+    shards_.at(shard).push_back(command);
+    return true;
+}
+
+unsigned long ParallelReplay::size() const
+{
+    return size_;
+}
+
+bool ParallelReplay::run(Hospital& hospital, unsigned long& errors)
+{
+    // Every shard starts from a copy of the hospital, and their output is
+    // thrown away.
+    std::string snapshot;
+    hospital.write_snapshot(snapshot);
+    std::vector<std::unique_ptr<Hospital>> shards;
+    std::vector<Hospital*> shard_pointers;
+    std::vector<Hospital::ReplayOrder> orders(shards_.size());
+    std::vector<unsigned long> shard_errors(shards_.size(), 0);
+    std::vector<std::vector<Record>> records(shards_.size());
+    std::vector<std::thread> workers;
+    for ( unsigned int i = 0; i < shards_.size(); ++i )
+    {
+        shards.emplace_back(new Hospital());
+        shard_pointers.push_back(shards.back().get());
+    }
+    for ( unsigned int i = 0; i < shards_.size(); ++i )
+    {
+        workers.emplace_back([this, i, &snapshot, &shards, &orders,
+                              &shard_errors, &records]()
+        {
+            Hospital& shard = *shards.at(i);
+            shard.output().set_discard(true);
+            shard.read_snapshot(snapshot);
+            shard.update_replay_order(orders.at(i), 0);
+            run_shard(shard, shards_.at(i), orders.at(i),
+                      shard_errors.at(i), records.at(i));
+        });
+    }
+    unsigned long total_errors = 0;
+    for ( unsigned int i = 0; i < shards_.size(); ++i )
+    {
+        workers.at(i).join();
+        total_errors += shard_errors.at(i);
+    }
+
+    if (not hospital.merge_shards(shard_pointers, orders))
+    {
+        // A failed merge may have emptied the hospital. Its history is
+        // untouched, since the commands are recorded only after the merge.
+        hospital.read_snapshot(snapshot);
+        return false;
+    }
+    record_history(hospital, records);
+    errors += total_errors;
+    return true;
+}
+
+void ParallelReplay::run_shard(Hospital& shard,
+                               const std::vector<Command>& commands,
+                               Hospital::ReplayOrder& order,
+                               unsigned long& errors,
+                               std::vector<Record>& records) const
+{
+    std::vector<std::string_view> params;
+    for ( const Command& command : commands )
+    {
+        params.assign(params_.begin() + command.first_param,
+                      params_.begin() + command.first_param +
+                      command.param_count);
+        unsigned long errors_before = shard.error_count();
+        (shard.*(command.change))(params);
+        if ( command.counts_errors )
+        {
+            if ( shard.error_count() != errors_before )
+            {
+                ++errors;
+            }
+            else
+            {
+                records.push_back({&command, shard.day_number()});
+            }
+        }
+        shard.update_replay_order(order, command.position);
+    }
+}
+
+void ParallelReplay::record_history(
+        Hospital& hospital, std::vector<std::vector<Record>>& records) const
+{
+    // Records of each shard are in the order of the log, so they are merged
+    // into the first one.
+    std::vector<Record>& all = records.at(0);
+    for ( unsigned int i = 1; i < records.size(); ++i )
+    {
+        std::size_t middle = all.size();
+        all.insert(all.end(), records.at(i).begin(), records.at(i).end());
+        std::inplace_merge(all.begin(), all.begin() + middle, all.end(),
+                           [](const Record& lhs, const Record& rhs)
+                           { return lhs.command->position <
+                                    rhs.command->position; });
+        std::vector<Record>().swap(records.at(i));
+    }
+    std::vector<std::string_view> params;
+    for ( const Record& record : all )
+    {
+        const Command& command = *record.command;
+        params.assign(params_.begin() + command.first_param,
+                      params_.begin() + command.first_param +
+                      command.param_count);
+        hospital.record_replayed(command.operation, params, record.day);
+    }
+}
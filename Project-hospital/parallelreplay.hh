@@ -0,0 +1,94 @@
+/* Class ParallelReplay
+ * ----------
+ * COMP.CS.110 SPRING 2021
+ * ----------
+ * Class for replaying a long log of changes on several threads. Patients
+ * are divided between shards by their names, and each shard is a hospital
+ * of its own run by a worker thread. Commands of a patient (enter, leave,
+ * add and remove medicine, assign staff) go only to the shard of the
+ * patient. Commands of staff and dates (recruit, set and advance date) go
+ * to every shard, so every shard sees the same staff on the same dates as
+ * a serial run would, and the shards never need to wait for each other.
+ *
+ * When all shards are done, their states are merged into the hospital in
+ * the order of the log, so the result is the same as if the commands had
+ * been run one by one. The successful changes are added to the history of
+ * the hospital in the order of the log with the dates they were run on, as
+ * if they had been run one by one.
+ * */
+#ifndef PARALLELREPLAY_HH
+#define PARALLELREPLAY_HH
+
+#include "hospital.hh"
+#include <string_view>
+#include <vector>
+
+// Change command of the hospital.
+using Change = void (Hospital::*)(Params params);
+
+class ParallelReplay
+{
+public:
+    // Constructor, the commands are divided between the given number of
+    // shards.
+    explicit ParallelReplay(unsigned int shards);
+
+    // Adds a command to be replayed. The parameters must stay alive until
+    // the replay has been run. Returns false if the command is not one of
+    // the changes that can be divided between shards.
+    bool add(Change change, Params params);
+
+    // Returns the number of commands added.
+    unsigned long size() const;
+
+    // Replays the commands added. Every shard starts from the state of the
+    // given hospital, and the state of the hospital is replaced with the
+    // result. Adds the number of commands that failed to errors. Returns
+    // false if the shards can't be merged, in which case the hospital is
+    // left as it was and the commands should be run one by one instead.
+    bool run(Hospital& hospital, unsigned long& errors);
+
+private:
+    // Command in a shard: the change and its operation in the journal, its
+    // position in the log (starting from 1), and its parameters in params_.
+    // Errors and history of commands run in every shard are taken only from
+    // the first shard.
+    struct Command
+    {
+        Change change;
+        Journal::Operation operation;
+        unsigned long position;
+        std::size_t first_param;
+        std::size_t param_count;
+        bool counts_errors;
+    };
+
+    // Commands of each shard in the order of the log.
+    std::vector<std::vector<Command>> shards_;
+
+    // Parameters of all commands.
+    std::vector<std::string_view> params_;
+
+    unsigned long size_;
+
+    // Successful command of a shard and the day it was run on.
+    struct Record
+    {
+        const Command* command;
+        unsigned int day;
+    };
+
+    // Runs the commands of a shard, recording the positions where the
+    // shard created patients, medicines and care periods, and the commands
+    // that succeeded.
+    void run_shard(Hospital& shard, const std::vector<Command>& commands,
+                   Hospital::ReplayOrder& order, unsigned long& errors,
+                   std::vector<Record>& records) const;
+
+    // Adds the records of all shards to the history of the hospital in the
+    // order of the log.
+    void record_history(Hospital& hospital,
+                        std::vector<std::vector<Record>>& records) const;
+};
+
+#endif // PARALLELREPLAY_HH
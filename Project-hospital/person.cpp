@@ -1,18 +1,18 @@
 #include "person.hh"
-#include <iostream>
 #include <map>
 
-Person::Person()
+Person::Person():
+    id_(0)
 {
 }
 
-Person::Person(const std::string &id):
+Person::Person(Handle id):
     id_(id)
 {
     date_of_birth_ = Date();
 }
 
-Person::Person(const std::string& id, const std::string& date_of_birth):
+Person::Person(Handle id, const std::string& date_of_birth):
     id_(id), date_of_birth_(date_of_birth)
 {
 }
@@ -21,15 +21,15 @@ Person::~Person()
 {
 }
 
-std::string Person::get_id() const
+Handle Person::get_id() const
 {
     return id_;
 }
 
-std::vector<std::string> Person::get_medicines() const
+std::vector<Handle> Person::get_medicines() const
 {
-    std::vector<std::string> result;
-    for( std::map<std::string, Prescription>::const_iterator
+    std::vector<Handle> result;
+    for( std::map<Handle, Prescription>::const_iterator
          iter = medicines_.begin();
          iter != medicines_.end();
          ++iter )
@@ -39,50 +39,60 @@ std::vector<std::string> Person::get_medicines() const
     return result;
 }
 
-void Person::add_medicine(const std::string& name,
+bool Person::get_prescription(Handle medicine, unsigned int& strength,
+                              unsigned int& dosage) const
+{
+    std::map<Handle, Prescription>::const_iterator
+            iter = medicines_.find(medicine);
+    if( iter == medicines_.end() )
+    {
+        return false;
+    }
+    strength = iter->second.strength_;
+    dosage = iter->second.dosage_;
+    return true;
+}
+
+bool Person::add_medicine(Handle medicine,
                           unsigned int strength,
                           unsigned int dosage)
 {
     Prescription pre;
     pre.strength_ = strength;
     pre.dosage_ = dosage;
-    if( medicines_.find(name) != medicines_.end() )
-    {
-        medicines_.at(name) = pre;
-    }
-    else
+    std::map<Handle, Prescription>::iterator iter = medicines_.find(medicine);
+    if( iter != medicines_.end() )
     {
-        medicines_.insert({name, pre});
+        iter->second = pre;
+        return false;
     }
+    medicines_.insert({medicine, pre});
+    return true;
 }
 
-void Person::remove_medicine(const std::string& name)
+bool Person::remove_medicine(Handle medicine)
 {
-    medicines_.erase(name);
+    return medicines_.erase(medicine) > 0;
 }
 
-void Person::print_id() const
-{
-    std::cout << id_;
-}
-
-void Person::print_medicines(const std::string& pre_text) const
+void Person::print_medicines(ReportWriter& out, const std::string& pre_text,
+                             const SymbolTable& medicine_names) const
 {
     if( medicines_.empty() )
     {
-        std::cout << " None" << std::endl;
+        out << " None" << '\n';
         return;
     }
-    std::cout << std::endl;
-    for( std::map<std::string, Prescription>::const_iterator
-         iter = medicines_.begin();
-         iter != medicines_.end();
-         ++iter )
+    out << '\n';
+    std::vector<Handle> medicines = get_medicines();
+    medicine_names.sort(medicines);
+    for( Handle medicine : medicines )
     {
-        std::cout << pre_text
-                  << iter->first << " "
-                  << iter->second.strength_ << " mg x "
-                  << iter->second.dosage_ << std::endl;
+        const Prescription& pre = medicines_.at(medicine);
+        out << pre_text
+                  << medicine_names.name(medicine) << " "
+                  << pre.strength_ << " mg x "
+                  << pre.dosage_ << '\n';
     }
 }
 
@@ -90,4 +100,3 @@ bool Person::operator<(const Person &rhs) const
 {
     return id_ < rhs.id_;
 }
-
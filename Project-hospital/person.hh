@@ -11,6 +11,8 @@
 #define PERSON_HH
 
 #include "date.hh"
+#include "reportwriter.hh"
+#include "symboltable.hh"
 #include <string>
 #include <map>
 #include <vector>
@@ -21,38 +23,44 @@ public:
     // Default constructor.
     Person();
 
-    // Constructor with an id.
-    Person(const std::string& id);
+    // Constructor with an id handle.
+    Person(Handle id);
 
-    // Constructor with an id and a date of birth (actually useless)
-    Person(const std::string& id, const std::string& date_of_birth);
+    // Constructor with an id handle and a date of birth (actually useless)
+    Person(Handle id, const std::string& date_of_birth);
 
     // Destructor.
     ~Person();
 
     // Obvious getter methods.
-    std::string get_id() const;
-    std::vector<std::string> get_medicines() const;
+    Handle get_id() const;
+    std::vector<Handle> get_medicines() const;
 
-    // Adds a medicine for the person.
-    void add_medicine(const std::string& name,
+    // Finds the prescription of the given medicine. Returns false if the
+    // person does not have the medicine.
+    bool get_prescription(Handle medicine, unsigned int& strength,
+                          unsigned int& dosage) const;
+
+    // Adds a medicine for the person. Returns true if the person did not
+    // have the medicine earlier.
+    bool add_medicine(Handle medicine,
                       unsigned int strength,
                       unsigned int dosage);
 
-    // Removes medicine from the person.
-    void remove_medicine(const std::string& name);
-
-    // Prints person's id.
-    void print_id() const;
+    // Removes medicine from the person. Returns true if the person had
+    // the medicine.
+    bool remove_medicine(Handle medicine);
 
-    // Prints person's medicines.
-    void print_medicines(const std::string& pre_text) const;
+    // Prints person's medicines in alphabetical order. Names of the
+    // medicines are taken from the given symbol table.
+    void print_medicines(ReportWriter& out, const std::string& pre_text,
+                         const SymbolTable& medicine_names) const;
 
     // Comparison operator, enables forming a set of Person objects.
     bool operator<(const Person& rhs) const;
 
 private:
-    std::string id_;     // Can be a name or any other identifier
+    Handle id_;          // Handle of a name or any other identifier
     Date date_of_birth_; // Not actually needed
 
     struct Prescription
@@ -60,8 +68,8 @@ private:
         unsigned int strength_;
         unsigned int dosage_;
     };
-    // Medicine names and their prescriptions
-    std::map<std::string, Prescription> medicines_;
+    // Medicine handles and their prescriptions
+    std::map<Handle, Prescription> medicines_;
 };
 
 #endif // PERSON_HH
@@ -0,0 +1,184 @@
+#include "prescriptionlog.hh"
+#include <algorithm>
+
+PrescriptionLog::PrescriptionLog():
+    leaves_(0)
+{
+}
+
+unsigned int PrescriptionLog::add(unsigned int care_period, Handle medicine,
+                                  unsigned int strength, unsigned int dosage,
+                                  unsigned int start_day)
+{
+    care_periods_.push_back(care_period);
+    medicines_.push_back(medicine);
+    strengths_.push_back(strength);
+    dosages_.push_back(dosage);
+    start_days_.push_back(start_day);
+    end_days_.push_back(OPEN_END);
+    return care_periods_.size() - 1;
+}
+
+void PrescriptionLog::end(unsigned int row, unsigned int end_day)
+{
+    end_days_.at(row) = end_day;
+    if ( row >= positions_.size() )
+    {
+        return;
+    }
+    std::size_t node = leaves_ + positions_[row];
+    max_ends_[node] = end_day;
+    for ( node /= 2; node > 0; node /= 2 )
+    {
+        max_ends_[node] = std::max(max_ends_[2 * node],
+                                   max_ends_[2 * node + 1]);
+    }
+}
+
+unsigned int PrescriptionLog::size() const
+{
+    return care_periods_.size();
+}
+
+unsigned int PrescriptionLog::care_period(unsigned int row) const
+{
+    return care_periods_.at(row);
+}
+
+Handle PrescriptionLog::medicine(unsigned int row) const
+{
+    return medicines_.at(row);
+}
+
+unsigned int PrescriptionLog::strength(unsigned int row) const
+{
+    return strengths_.at(row);
+}
+
+unsigned int PrescriptionLog::dosage(unsigned int row) const
+{
+    return dosages_.at(row);
+}
+
+unsigned int PrescriptionLog::start_day(unsigned int row) const
+{
+    return start_days_.at(row);
+}
+
+unsigned int PrescriptionLog::end_day(unsigned int row) const
+{
+    return end_days_.at(row);
+}
+
+void PrescriptionLog::find(Handle medicine, unsigned int first,
+                           unsigned int last,
+                           std::vector<unsigned int>& rows) const
+{
+    update_sorted();
+    rows.clear();
+
+    // Rows of the medicine starting on the last day at the latest, found
+    // by binary search, of which those not ended before the first day are
+    // found in the tree.
+    std::vector<unsigned int>::const_iterator begin =
+            std::partition_point(sorted_.cbegin(), sorted_.cend(),
+                                 [this, medicine](unsigned int row)
+                                 { return medicines_[row] < medicine; });
+    std::vector<unsigned int>::const_iterator end =
+            std::partition_point(begin, sorted_.cend(),
+                                 [this, medicine, last](unsigned int row)
+                                 { return medicines_[row] == medicine and
+                                          start_days_[row] <= last; });
+    if ( begin != end )
+    {
+        find(1, 0, leaves_, begin - sorted_.cbegin(), end - sorted_.cbegin(),
+             first, rows);
+    }
+}
+
+void PrescriptionLog::clear()
+{
+    care_periods_.clear();
+    medicines_.clear();
+    strengths_.clear();
+    dosages_.clear();
+    start_days_.clear();
+    end_days_.clear();
+    sorted_.clear();
+    positions_.clear();
+    max_ends_.clear();
+    leaves_ = 0;
+}
+
+bool PrescriptionLog::is_before(unsigned int lhs, unsigned int rhs) const
+{
+    if ( medicines_[lhs] != medicines_[rhs] )
+    {
+        return medicines_[lhs] < medicines_[rhs];
+    }
+    if ( start_days_[lhs] != start_days_[rhs] )
+    {
+        return start_days_[lhs] < start_days_[rhs];
+    }
+    return lhs < rhs;
+}
+
+void PrescriptionLog::update_sorted() const
+{
+    std::size_t old_size = sorted_.size();
+    if ( old_size == care_periods_.size() )
+    {
+        return;
+    }
+    for ( unsigned int row = old_size; row < care_periods_.size(); ++row )
+    {
+        sorted_.push_back(row);
+    }
+    auto is_before = [this](unsigned int lhs, unsigned int rhs)
+    {
+        return this->is_before(lhs, rhs);
+    };
+    std::sort(sorted_.begin() + old_size, sorted_.end(), is_before);
+    std::inplace_merge(sorted_.begin(), sorted_.begin() + old_size,
+                       sorted_.end(), is_before);
+
+    // The number of leaves is a power of two, those past the rows are never
+    // searched.
+    positions_.resize(sorted_.size());
+    leaves_ = 1;
+    while ( leaves_ < sorted_.size() )
+    {
+        leaves_ *= 2;
+    }
+    max_ends_.assign(2 * leaves_, 0);
+    for ( std::size_t i = 0; i < sorted_.size(); ++i )
+    {
+        positions_[sorted_[i]] = i;
+        max_ends_[leaves_ + i] = end_days_[sorted_[i]];
+    }
+    for ( std::size_t node = leaves_ - 1; node > 0; --node )
+    {
+        max_ends_[node] = std::max(max_ends_[2 * node],
+                                   max_ends_[2 * node + 1]);
+    }
+}
+
+void PrescriptionLog::find(std::size_t node, std::size_t node_begin,
+                           std::size_t node_end, std::size_t begin,
+                           std::size_t end, unsigned int first,
+                           std::vector<unsigned int>& rows) const
+{
+    // Nothing searched for here, or every row here ended too early.
+    if ( node_end <= begin or end <= node_begin or max_ends_[node] < first )
+    {
+        return;
+    }
+    if ( node >= leaves_ )
+    {
+        rows.push_back(sorted_[node_begin]);
+        return;
+    }
+    std::size_t middle = node_begin + (node_end - node_begin) / 2;
+    find(2 * node, node_begin, middle, begin, end, first, rows);
+    find(2 * node + 1, middle, node_end, begin, end, first, rows);
+}
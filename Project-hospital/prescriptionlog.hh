@@ -0,0 +1,98 @@
+/* Class PrescriptionLog
+ * ----------
+ * COMP.CS.110 SPRING 2021
+ * ----------
+ * Class for the history of all prescriptions of the hospital. Every time a
+ * medicine is prescribed (or its strength or dosage changes) a row is
+ * appended: care period where it was prescribed, medicine, strength,
+ * dosage, start day and end day. The only change ever made to a row is
+ * filling in its end day when the prescription is removed or replaced, so
+ * rows are never moved or deleted.
+ *
+ * Rows are stored column by column, each column a flat array of 32 bit
+ * numbers, so a row takes 24 bytes. Queries by medicine and days use a
+ * view of the rows sorted by medicine and start day. Over the view there is
+ * a segment tree of the latest end day of each range of rows, so rows ended
+ * before the first day are skipped a range at a time, like IntervalIndex
+ * skips subtrees. The view is brought up to date when it is next used after
+ * rows have been added: only the new rows are sorted and merged into it,
+ * and the tree is built again.
+ * */
+#ifndef PRESCRIPTIONLOG_HH
+#define PRESCRIPTIONLOG_HH
+
+#include "symboltable.hh"
+#include <cstdint>
+#include <vector>
+
+class PrescriptionLog
+{
+public:
+    // End day of a prescription still in use.
+    static constexpr unsigned int OPEN_END = ~0u;
+
+    // Constructor.
+    PrescriptionLog();
+
+    // Appends a prescription starting on the given day and returns its row.
+    unsigned int add(unsigned int care_period, Handle medicine,
+                     unsigned int strength, unsigned int dosage,
+                     unsigned int start_day);
+
+    // Sets the end day of the prescription in the given row.
+    void end(unsigned int row, unsigned int end_day);
+
+    // Returns the number of rows.
+    unsigned int size() const;
+
+    // Getters of the columns of a row.
+    unsigned int care_period(unsigned int row) const;
+    Handle medicine(unsigned int row) const;
+    unsigned int strength(unsigned int row) const;
+    unsigned int dosage(unsigned int row) const;
+    unsigned int start_day(unsigned int row) const;
+    unsigned int end_day(unsigned int row) const;
+
+    // Finds the rows of the given medicine in use on some day between the
+    // given days, both included, in the order of their start days.
+    void find(Handle medicine, unsigned int first, unsigned int last,
+              std::vector<unsigned int>& rows) const;
+
+    // Removes all rows.
+    void clear();
+
+private:
+    std::vector<std::uint32_t> care_periods_;
+    std::vector<Handle> medicines_;
+    std::vector<std::uint32_t> strengths_;
+    std::vector<std::uint32_t> dosages_;
+    std::vector<std::uint32_t> start_days_;
+    std::vector<std::uint32_t> end_days_;
+
+    // The first sorted_.size() rows sorted by medicine, start day and row.
+    mutable std::vector<unsigned int> sorted_;
+
+    // Position of each row of the view in sorted_.
+    mutable std::vector<unsigned int> positions_;
+
+    // Segment tree of the latest end days of ranges of sorted_: node 1
+    // covers all of it, node i has children 2i and 2i+1, and the leaves
+    // start at leaves_.
+    mutable std::vector<std::uint32_t> max_ends_;
+    mutable std::size_t leaves_;
+
+    // Returns true if the first row comes before the second one in sorted_.
+    bool is_before(unsigned int lhs, unsigned int rhs) const;
+
+    // Adds the rows appended after the latest update to the sorted view.
+    void update_sorted() const;
+
+    // Appends the rows of the given positions of sorted_ not ended before
+    // the first day, from the subtree of the node covering the given
+    // positions, in their order.
+    void find(std::size_t node, std::size_t node_begin, std::size_t node_end,
+              std::size_t begin, std::size_t end, unsigned int first,
+              std::vector<unsigned int>& rows) const;
+};
+
+#endif // PRESCRIPTIONLOG_HH
@@ -0,0 +1,137 @@
+#include "reportrunner.hh"
+#include "binaryio.hh"
+
+ReportRunner::ReportRunner():
+    following_(nullptr),
+    changes_{"", 0},
+    stopping_(false)
+{
+}
+
+ReportRunner::~ReportRunner()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.clear();
+        stopping_ = true;
+    }
+    job_added_.notify_one();
+    if ( worker_.joinable() )
+    {
+        worker_.join();
+    }
+}
+
+void ReportRunner::start(Hospital& hospital, Report report, Params params)
+{
+    // A new snapshot is needed only if the log is missing changes.
+    std::shared_ptr<std::string> snapshot;
+    std::shared_ptr<std::string> changes;
+    if ( following_ != &hospital or changes_.version != hospital.version() )
+    {
+        snapshot = std::make_shared<std::string>();
+        hospital.write_snapshot(*snapshot);
+        following_ = &hospital;
+        changes_.records.clear();
+        changes_.version = hospital.version();
+        hospital.set_change_log(&changes_);
+    }
+    else if ( not changes_.records.empty() )
+    {
+        changes = std::make_shared<std::string>();
+        changes->swap(changes_.records);
+    }
+
+    std::unique_ptr<Job> job(new Job{report,
+                                     std::vector<std::string>(params.begin(),
+                                                              params.end()),
+                                     snapshot, changes, "", false});
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.push_back(job.get());
+        jobs_.push_back(std::move(job));
+    }
+    if ( not worker_.joinable() )
+    {
+        worker_ = std::thread(&ReportRunner::work, this);
+    }
+    job_added_.notify_one();
+}
+
+void ReportRunner::write_finished(ReportWriter& out)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    while ( not jobs_.empty() and jobs_.front()->done )
+    {
+        out << jobs_.front()->output;
+        jobs_.pop_front();
+    }
+}
+
+void ReportRunner::write_all(ReportWriter& out)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while ( not jobs_.empty() )
+    {
+        job_done_.wait(lock, [this]() { return jobs_.front()->done; });
+        out << jobs_.front()->output;
+        jobs_.pop_front();
+    }
+}
+
+void ReportRunner::stop_following(Hospital& hospital)
+{
+    if ( following_ == &hospital )
+    {
+        hospital.set_change_log(nullptr);
+        following_ = nullptr;
+        changes_.records.clear();
+    }
+}
+
+void ReportRunner::work()
+{
+    // Copy of the hospital.
+    Hospital hospital;
+    std::vector<std::string_view> params;
+    std::vector<std::string> values;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while ( true )
+    {
+        job_added_.wait(lock, [this]()
+                        { return stopping_ or not pending_.empty(); });
+        if ( pending_.empty() )
+        {
+            return;
+        }
+        Job* job = pending_.front();
+        pending_.pop_front();
+        lock.unlock();
+
+        if ( job->snapshot != nullptr )
+        {
+            hospital.read_snapshot(*job->snapshot);
+        }
+        if ( job->changes != nullptr )
+        {
+            // Messages of the replayed changes are not wanted.
+            BinaryReader records(job->changes->data(),
+                                 job->changes->data() + job->changes->size());
+            hospital.output().set_discard(true);
+            while ( not records.at_end() and
+                    Journal::run_record(records, hospital, values, params) )
+            {
+            }
+            hospital.output().set_discard(false);
+        }
+        params.assign(job->params.begin(), job->params.end());
+        hospital.output().set_string(&job->output);
+        (hospital.*(job->report))(params);
+        hospital.output().set_string(nullptr);
+
+        lock.lock();
+        job->done = true;
+        job_done_.notify_one();
+    }
+}
@@ -0,0 +1,96 @@
+/* Class ReportRunner
+ * ----------
+ * COMP.CS.110 SPRING 2021
+ * ----------
+ * Class for running print commands on a worker thread, so that long
+ * reports do not stop the hospital from taking in changes. Every report
+ * runs against a copy of the hospital as it was when the report was
+ * started. The worker keeps the copy in a hospital of its own. The copy
+ * starts from a snapshot of the hospital, after which the hospital appends
+ * its changes into a log, and each report takes the changes made since the
+ * previous one for the worker to replay into the copy. So the calling
+ * thread only encodes the changes, and writes a whole snapshot again only
+ * after changes that can't be logged (loading a snapshot or merging replay
+ * shards). Reports started without changes in between share the same copy.
+ *
+ * Output of the reports is collected into strings and printed by the
+ * calling thread in the order the reports were started.
+ * */
+#ifndef REPORTRUNNER_HH
+#define REPORTRUNNER_HH
+
+#include "hospital.hh"
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+class ReportRunner
+{
+public:
+    // Constructor. The worker thread is started with the first report.
+    ReportRunner();
+
+    // Destructor, waits for the report running and drops the others.
+    ~ReportRunner();
+
+    ReportRunner(const ReportRunner&) = delete;
+    ReportRunner& operator=(const ReportRunner&) = delete;
+
+    // Starts the given report of the hospital in its current state.
+    void start(Hospital& hospital, Report report, Params params);
+
+    // Writes the output of the reports finished so far into the given
+    // writer, stopping at the first report still running.
+    void write_finished(ReportWriter& out);
+
+    // Waits for all reports to finish and writes their output into the
+    // given writer.
+    void write_all(ReportWriter& out);
+
+    // Stops the hospital from appending its changes into the runner. The
+    // next report starts from a new snapshot.
+    void stop_following(Hospital& hospital);
+
+private:
+    struct Job
+    {
+        Report report;
+        std::vector<std::string> params;
+        // Snapshot to load into the copy, or null to keep the copy, and
+        // the changes to replay into it after that, or null if there are
+        // none.
+        std::shared_ptr<const std::string> snapshot;
+        std::shared_ptr<const std::string> changes;
+        std::string output;
+        bool done;
+    };
+
+    // Jobs in the order they were started, until their output is written.
+    std::deque<std::unique_ptr<Job>> jobs_;
+
+    // Jobs the worker has not yet taken.
+    std::deque<Job*> pending_;
+
+    // The hospital appending its changes into changes_, or null before
+    // the first report. The changes are the ones made since the previous
+    // report.
+    Hospital* following_;
+    Hospital::ChangeLog changes_;
+
+    // Protects jobs_, pending_, stopping_ and the done flags of jobs.
+    std::mutex mutex_;
+    std::condition_variable job_added_;
+    std::condition_variable job_done_;
+    bool stopping_;
+    std::thread worker_;
+
+    // Runs the jobs until stopped.
+    void work();
+};
+
+#endif // REPORTRUNNER_HH
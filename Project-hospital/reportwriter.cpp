@@ -0,0 +1,142 @@
+#include "reportwriter.hh"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <unistd.h>
+
+ReportWriter::ReportWriter():
+    buffer_(BUFFER_SIZE), used_(0), fd_(-1), text_(nullptr), discard_(false)
+{
+}
+
+ReportWriter::~ReportWriter()
+{
+    flush();
+}
+
+void ReportWriter::set_file_descriptor(int fd)
+{
+    flush();
+    fd_ = fd;
+}
+
+void ReportWriter::set_string(std::string* text)
+{
+    flush();
+    text_ = text;
+}
+
+void ReportWriter::set_discard(bool discard)
+{
+    discard_ = discard;
+}
+
+bool ReportWriter::is_discarding() const
+{
+    return discard_;
+}
+
+ReportWriter& ReportWriter::operator<<(std::string_view text)
+{
+    if ( not discard_ )
+    {
+        write(text.data(), text.size());
+    }
+    return *this;
+}
+
+ReportWriter& ReportWriter::operator<<(const char* text)
+{
+    if ( not discard_ )
+    {
+        write(text, std::strlen(text));
+    }
+    return *this;
+}
+
+ReportWriter& ReportWriter::operator<<(char character)
+{
+    if ( not discard_ )
+    {
+        write(&character, 1);
+    }
+    return *this;
+}
+
+ReportWriter& ReportWriter::operator<<(unsigned int number)
+{
+    return *this << static_cast<unsigned long>(number);
+}
+
+ReportWriter& ReportWriter::operator<<(unsigned long number)
+{
+    if ( discard_ )
+    {
+        return *this;
+    }
+    // Digits are formatted from the end of the array.
+    char digits[20];
+    char* first = digits + sizeof(digits);
+    do
+    {
+        *--first = '0' + number % 10;
+        number /= 10;
+    }
+    while ( number != 0 );
+    write(first, digits + sizeof(digits) - first);
+    return *this;
+}
+
+void ReportWriter::flush()
+{
+    if ( used_ == 0 )
+    {
+        return;
+    }
+    if ( text_ != nullptr )
+    {
+        text_->append(buffer_.data(), used_);
+        used_ = 0;
+        return;
+    }
+    if ( fd_ < 0 )
+    {
+        std::cout.write(buffer_.data(), used_);
+        used_ = 0;
+        return;
+    }
+
+    // Anything printed through std::cout must come out first.
+    std::cout.flush();
+    const char* data = buffer_.data();
+    std::size_t left = used_;
+    while ( left > 0 )
+    {
+        ssize_t written = ::write(fd_, data, left);
+        if ( written < 0 )
+        {
+            if ( errno == EINTR )
+            {
+                continue;
+            }
+            break;
+        }
+        data += written;
+        left -= written;
+    }
+    used_ = 0;
+}
+
+void ReportWriter::write(const char* data, std::size_t size)
+{
+    if ( used_ + size > buffer_.size() )
+    {
+        flush();
+        if ( size > buffer_.size() )
+        {
+            buffer_.resize(size);
+        }
+    }
+    std::memcpy(buffer_.data() + used_, data, size);
+    used_ += size;
+}
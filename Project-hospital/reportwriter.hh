@@ -0,0 +1,68 @@
+/* Class ReportWriter
+ * ----------
+ * COMP.CS.110 SPRING 2021
+ * ----------
+ * Class for writing the output of the hospital. Output is collected into
+ * a buffer and written out only when flush is called (at the end of every
+ * command) or when the buffer becomes full. By default output goes to
+ * std::cout, but it can also be written straight to a file descriptor,
+ * collected into a string or discarded altogether.
+ * */
+#ifndef REPORTWRITER_HH
+#define REPORTWRITER_HH
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class ReportWriter
+{
+public:
+    // Constructor. Output goes to std::cout.
+    ReportWriter();
+
+    // Destructor, flushes the remaining output.
+    ~ReportWriter();
+
+    ReportWriter(const ReportWriter&) = delete;
+    ReportWriter& operator=(const ReportWriter&) = delete;
+
+    // Makes output go straight to the given file descriptor. Value -1
+    // means std::cout.
+    void set_file_descriptor(int fd);
+
+    // Makes output be appended to the given string instead. Null pointer
+    // means the file descriptor set earlier.
+    void set_string(std::string* text);
+
+    // If discard is true, everything written is thrown away (and not even
+    // formatted) until discard is set false again.
+    void set_discard(bool discard);
+    bool is_discarding() const;
+
+    // Output operators.
+    ReportWriter& operator<<(std::string_view text);
+    ReportWriter& operator<<(const char* text);
+    ReportWriter& operator<<(char character);
+    ReportWriter& operator<<(unsigned int number);
+    ReportWriter& operator<<(unsigned long number);
+
+    // Writes out the buffered output.
+    void flush();
+
+private:
+    // Size of the buffer, the buffer is flushed when it becomes full.
+    static const std::size_t BUFFER_SIZE = 1 << 16;
+
+    std::vector<char> buffer_;
+    std::size_t used_;
+    int fd_;
+    std::string* text_;
+    bool discard_;
+
+    // Adds the given characters to the buffer.
+    void write(const char* data, std::size_t size);
+};
+
+#endif // REPORTWRITER_HH
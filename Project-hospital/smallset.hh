@@ -0,0 +1,208 @@
+/* Class SmallSet
+ * ----------
+ * COMP.CS.110 SPRING 2021
+ * ----------
+ * Class template for a sorted set of small values, such as handles. Values
+ * are kept in a sorted array and found with binary search. The first N
+ * values are stored inside the set itself, so small sets never allocate
+ * memory. A larger set moves its values to an array in the heap, which
+ * then grows by doubling.
+ *
+ * The inline values and the pointer to the heap array share the same
+ * memory, so the set is only slightly larger than its inline values.
+ * Values must be trivially copyable.
+ * */
+#ifndef SMALLSET_HH
+#define SMALLSET_HH
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+
+template <typename T, unsigned int N>
+class SmallSet
+{
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "SmallSet values must be trivially copyable");
+    static_assert(N > 0, "SmallSet needs room for at least one value");
+
+public:
+    // Iterator over values in ascending order.
+    using const_iterator = const T*;
+
+    // Constructor.
+    SmallSet();
+
+    // Destructor.
+    ~SmallSet();
+
+    SmallSet(const SmallSet& other);
+    SmallSet& operator=(const SmallSet& other);
+
+    // Adds a value to the set. Returns false if it was already there.
+    bool insert(const T& value);
+
+    // Returns true if the value is in the set.
+    bool contains(const T& value) const;
+
+    // Returns the number of values.
+    std::uint32_t size() const;
+
+    // Returns true if the set has no values.
+    bool empty() const;
+
+    // Iterators for going through the values in ascending order. Adding
+    // values invalidates the iterators.
+    const_iterator begin() const;
+    const_iterator end() const;
+
+private:
+    // Values inside the set while there are at most N of them, otherwise
+    // the array in the heap.
+    union
+    {
+        T inline_[N];
+        T* heap_;
+    };
+
+    std::uint32_t size_;
+
+    // Number of values that fit in the current storage.
+    std::uint32_t capacity_;
+
+    // Returns true if the values are in the heap.
+    bool is_heap() const;
+
+    // Returns the first value.
+    T* data();
+    const T* data() const;
+};
+
+template <typename T, unsigned int N>
+SmallSet<T, N>::SmallSet():
+    size_(0), capacity_(N)
+{
+}
+
+template <typename T, unsigned int N>
+SmallSet<T, N>::~SmallSet()
+{
+    if ( is_heap() )
+    {
+        delete[] heap_;
+    }
+}
+
+template <typename T, unsigned int N>
+SmallSet<T, N>::SmallSet(const SmallSet& other):
+    size_(other.size_), capacity_(N)
+{
+    if ( other.size_ > N )
+    {
+        heap_ = new T[other.size_];
+        capacity_ = other.size_;
+    }
+    std::copy(other.begin(), other.end(), data());
+}
+
+template <typename T, unsigned int N>
+SmallSet<T, N>& SmallSet<T, N>::operator=(const SmallSet& other)
+{
+    if ( this == &other )
+    {
+        return *this;
+    }
+    if ( is_heap() )
+    {
+        delete[] heap_;
+    }
+    size_ = other.size_;
+    capacity_ = N;
+    if ( other.size_ > N )
+    {
+        heap_ = new T[other.size_];
+        capacity_ = other.size_;
+    }
+    std::copy(other.begin(), other.end(), data());
+    return *this;
+}
+
+template <typename T, unsigned int N>
+bool SmallSet<T, N>::insert(const T& value)
+{
+    T* first = data();
+    T* place = std::lower_bound(first, first + size_, value);
+    if ( place != first + size_ and not (value < *place) )
+    {
+        return false;
+    }
+    if ( size_ == capacity_ )
+    {
+        // Moves the values into a twice as large heap array.
+        std::uint32_t offset = place - first;
+        T* values = new T[capacity_ * 2];
+        std::copy(first, first + size_, values);
+        if ( is_heap() )
+        {
+            delete[] heap_;
+        }
+        heap_ = values;
+        capacity_ *= 2;
+        first = values;
+        place = first + offset;
+    }
+    std::copy_backward(place, first + size_, first + size_ + 1);
+    *place = value;
+    ++size_;
+    return true;
+}
+
+template <typename T, unsigned int N>
+bool SmallSet<T, N>::contains(const T& value) const
+{
+    return std::binary_search(begin(), end(), value);
+}
+
+template <typename T, unsigned int N>
+std::uint32_t SmallSet<T, N>::size() const
+{
+    return size_;
+}
+
+template <typename T, unsigned int N>
+bool SmallSet<T, N>::empty() const
+{
+    return size_ == 0;
+}
+
+template <typename T, unsigned int N>
+typename SmallSet<T, N>::const_iterator SmallSet<T, N>::begin() const
+{
+    return data();
+}
+
+template <typename T, unsigned int N>
+typename SmallSet<T, N>::const_iterator SmallSet<T, N>::end() const
+{
+    return data() + size_;
+}
+
+template <typename T, unsigned int N>
+bool SmallSet<T, N>::is_heap() const
+{
+    return capacity_ > N;
+}
+
+template <typename T, unsigned int N>
+T* SmallSet<T, N>::data()
+{
+    return is_heap() ? heap_ : inline_;
+}
+
+template <typename T, unsigned int N>
+const T* SmallSet<T, N>::data() const
+{
+    return is_heap() ? heap_ : inline_;
+}
+
+#endif // SMALLSET_HH
@@ -0,0 +1,135 @@
+#include "symboltable.hh"
+#include <algorithm>
+#include <functional>
+
+// Number of slots in a new hash table.
+const std::size_t INITIAL_SLOTS = 16;
+
+SymbolTable::SymbolTable():
+    slots_(INITIAL_SLOTS, Slot{0, EMPTY})
+{
+}
+
+Handle SymbolTable::intern(std::string_view name)
+{
+    std::uint32_t name_hash = hash(name);
+    std::size_t slot = find_slot(name, name_hash);
+    if ( slots_.at(slot).handle != EMPTY )
+    {
+        return slots_.at(slot).handle;
+    }
+    Handle handle = names_.size();
+    names_.emplace_back(name);
+    slots_.at(slot) = Slot{name_hash, handle};
+    if ( names_.size() * 2 > slots_.size() )
+    {
+        grow();
+    }
+    return handle;
+}
+
+bool SymbolTable::find(std::string_view name, Handle& handle) const
+{
+    const Slot& slot = slots_.at(find_slot(name, hash(name)));
+    if ( slot.handle == EMPTY )
+    {
+        return false;
+    }
+    handle = slot.handle;
+    return true;
+}
+
+const std::string& SymbolTable::name(Handle handle) const
+{
+    return names_.at(handle);
+}
+
+unsigned int SymbolTable::size() const
+{
+    return names_.size();
+}
+
+void SymbolTable::clear()
+{
+    names_.clear();
+    slots_.assign(INITIAL_SLOTS, Slot{0, EMPTY});
+    sorted_.clear();
+}
+
+void SymbolTable::sort(std::vector<Handle>& handles) const
+{
+    std::sort(handles.begin(), handles.end(), ByName{this});
+}
+
+SymbolTable::const_iterator SymbolTable::begin() const
+{
+    update_sorted();
+    return sorted_.begin();
+}
+
+SymbolTable::const_iterator SymbolTable::end() const
+{
+    update_sorted();
+    return sorted_.end();
+}
+
+bool SymbolTable::ByName::operator()(Handle lhs, Handle rhs) const
+{
+    return table->name(lhs) < table->name(rhs);
+}
+
+std::uint32_t SymbolTable::hash(std::string_view name)
+{
+    return std::hash<std::string_view>()(name);
+}
+
+std::size_t SymbolTable::find_slot(std::string_view name,
+                                   std::uint32_t hash) const
+{
+    // The number of slots is a power of two.
+    std::size_t mask = slots_.size() - 1;
+    std::size_t slot = hash & mask;
+    while ( slots_.at(slot).handle != EMPTY and
+            ( slots_.at(slot).hash != hash or
+              names_.at(slots_.at(slot).handle) != name ) )
+    {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void SymbolTable::grow()
+{
+    std::vector<Slot> old_slots(slots_.size() * 2, Slot{0, EMPTY});
+    old_slots.swap(slots_);
+    std::size_t mask = slots_.size() - 1;
+    for ( const Slot& old_slot : old_slots )
+    {
+        if ( old_slot.handle == EMPTY )
+        {
+            continue;
+        }
+        std::size_t slot = old_slot.hash & mask;
+        while ( slots_.at(slot).handle != EMPTY )
+        {
+            slot = (slot + 1) & mask;
+        }
+        slots_.at(slot) = old_slot;
+    }
+}
+
+void SymbolTable::update_sorted() const
+{
+    std::size_t old_size = sorted_.size();
+    if ( old_size == names_.size() )
+    {
+        return;
+    }
+    for ( Handle handle = old_size; handle < names_.size(); ++handle )
+    {
+        sorted_.push_back(Entry{names_.at(handle), handle});
+    }
+    std::sort(sorted_.begin() + old_size, sorted_.end());
+    std::inplace_merge(sorted_.begin(), sorted_.begin() + old_size,
+                       sorted_.end());
+}
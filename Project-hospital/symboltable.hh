@@ -0,0 +1,108 @@
+/* Class SymbolTable
+ * ----------
+ * COMP.CS.110 SPRING 2021
+ * ----------
+ * Class for interning identifiers (names of patients, staff and medicines).
+ * Every different name gets a dense integer handle (0, 1, 2, ...) when it
+ * is first interned. Handles are used everywhere inside the hospital, and
+ * names are looked up again only when something is printed.
+ *
+ * Names are found through a flat open addressing hash table (linear
+ * probing), so a lookup usually touches one slot and one name. Alphabetical
+ * order is needed only for printing. It comes from a sorted view that is
+ * brought up to date when it is next used after new names have been added:
+ * only the new names are sorted and merged into the view.
+ * */
+#ifndef SYMBOLTABLE_HH
+#define SYMBOLTABLE_HH
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using Handle = unsigned int;
+
+class SymbolTable
+{
+public:
+    // Name and its handle.
+    using Entry = std::pair<std::string_view, Handle>;
+
+    // Iterator over entries in alphabetical order of names.
+    using const_iterator = std::vector<Entry>::const_iterator;
+
+    // Constructor.
+    SymbolTable();
+
+    // Returns the handle of the given name. If the name has not been
+    // interned earlier, gives it the next free handle.
+    Handle intern(std::string_view name);
+
+    // Finds the handle of the given name. Returns false if the name
+    // has not been interned.
+    bool find(std::string_view name, Handle& handle) const;
+
+    // Returns the name of the given handle.
+    const std::string& name(Handle handle) const;
+
+    // Returns the number of interned names.
+    unsigned int size() const;
+
+    // Removes all names.
+    void clear();
+
+    // Sorts the given handles in alphabetical order of their names.
+    void sort(std::vector<Handle>& handles) const;
+
+    // Iterators for going through all names in alphabetical order. Adding
+    // names invalidates the iterators.
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    // Comparison object ordering handles alphabetically by their names.
+    struct ByName
+    {
+        const SymbolTable* table;
+        bool operator()(Handle lhs, Handle rhs) const;
+    };
+
+private:
+    // Slot of the hash table: handle of a name and the hash of the name,
+    // so that most slots of other names are passed without comparing
+    // names. Unused slots have the handle EMPTY.
+    struct Slot
+    {
+        std::uint32_t hash;
+        Handle handle;
+    };
+    static const Handle EMPTY = ~0u;
+
+    // Names by handles. Names never move in a deque, so the entries of
+    // the sorted view can point to them.
+    std::deque<std::string> names_;
+
+    // Hash table, the number of slots is a power of two and at least
+    // twice the number of names.
+    std::vector<Slot> slots_;
+
+    // Entries of the first sorted_.size() handles in alphabetical order.
+    mutable std::vector<Entry> sorted_;
+
+    // Returns the hash of a name.
+    static std::uint32_t hash(std::string_view name);
+
+    // Returns the slot of the given name, or the empty slot where it
+    // would be.
+    std::size_t find_slot(std::string_view name, std::uint32_t hash) const;
+
+    // Doubles the number of slots.
+    void grow();
+
+    // Adds the names interned after the latest update to the sorted view.
+    void update_sorted() const;
+};
+
+#endif // SYMBOLTABLE_HH
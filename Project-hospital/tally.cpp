@@ -0,0 +1,78 @@
+#include "tally.hh"
+
+Tally::Tally()
+{
+}
+
+void Tally::add(Handle handle)
+{
+    if ( handle >= counts_.size() )
+    {
+        counts_.resize(handle + 1, 0);
+    }
+    unsigned int& count = counts_.at(handle);
+    // An entry is added for the first count and removed with the last one.
+    // Otherwise its node is moved to the new place without allocating.
+    if ( count == 0 )
+    {
+        ++count;
+        ranking_.insert({count, handle});
+        return;
+    }
+    std::set<Entry, ByCount>::node_type node =
+            ranking_.extract({count, handle});
+    ++count;
+    node.value().first = count;
+    ranking_.insert(std::move(node));
+}
+
+void Tally::remove(Handle handle)
+{
+    unsigned int& count = counts_.at(handle);
+    if ( count == 1 )
+    {
+        --count;
+        ranking_.erase({1, handle});
+        return;
+    }
+    std::set<Entry, ByCount>::node_type node =
+            ranking_.extract({count, handle});
+    --count;
+    node.value().first = count;
+    ranking_.insert(std::move(node));
+}
+
+unsigned int Tally::count(Handle handle) const
+{
+    return handle < counts_.size() ? counts_.at(handle) : 0;
+}
+
+unsigned int Tally::counted() const
+{
+    return ranking_.size();
+}
+
+void Tally::top(unsigned int amount, std::vector<Handle>& handles) const
+{
+    handles.clear();
+    for ( std::set<Entry, ByCount>::const_iterator iter = ranking_.begin();
+          iter != ranking_.end() and handles.size() < amount; ++iter )
+    {
+        handles.push_back(iter->second);
+    }
+}
+
+void Tally::clear()
+{
+    counts_.clear();
+    ranking_.clear();
+}
+
+bool Tally::ByCount::operator()(const Entry& lhs, const Entry& rhs) const
+{
+    if ( lhs.first != rhs.first )
+    {
+        return lhs.first > rhs.first;
+    }
+    return lhs.second < rhs.second;
+}
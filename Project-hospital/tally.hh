@@ -0,0 +1,64 @@
+/* Class Tally
+ * ----------
+ * COMP.CS.110 SPRING 2021
+ * ----------
+ * Class for counting something per name (e.g. current patients of each
+ * staff member) and ranking the names by their counts. Counts are changed
+ * one at a time as the hospital changes, so they never need to be counted
+ * again from the data.
+ *
+ * Counts are kept in an array indexed by handle. Handles with a count
+ * above zero are also kept in a balanced tree ordered by count (largest
+ * first) and handle, so a change takes logarithmic time without allocating
+ * and the k handles with the largest counts are found in O(k). Equal
+ * counts are in the order of handles, i.e. the order the names were first
+ * added, which compares faster than names.
+ * */
+#ifndef TALLY_HH
+#define TALLY_HH
+
+#include "symboltable.hh"
+#include <set>
+#include <utility>
+#include <vector>
+
+class Tally
+{
+public:
+    // Constructor.
+    Tally();
+
+    // Adds one to the count of the given handle.
+    void add(Handle handle);
+
+    // Subtracts one from the count of the given handle, which must be above
+    // zero.
+    void remove(Handle handle);
+
+    // Returns the count of the given handle.
+    unsigned int count(Handle handle) const;
+
+    // Returns the number of handles whose count is above zero.
+    unsigned int counted() const;
+
+    // Finds at most the given number of handles with the largest counts,
+    // in the order of counts and then handles.
+    void top(unsigned int amount, std::vector<Handle>& handles) const;
+
+    // Sets all counts to zero.
+    void clear();
+
+private:
+    // Count and handle, ordered by count from the largest and then by
+    // handle.
+    using Entry = std::pair<unsigned int, Handle>;
+    struct ByCount
+    {
+        bool operator()(const Entry& lhs, const Entry& rhs) const;
+    };
+
+    std::vector<unsigned int> counts_;
+    std::set<Entry, ByCount> ranking_;
+};
+
+#endif // TALLY_HH
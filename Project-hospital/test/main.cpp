@@ -0,0 +1,428 @@
+#include "workload.hh"
+#include "cli.hh"
+#include "eventlog.hh"
+#include "parallelreplay.hh"
+#include "reportrunner.hh"
+#include "utils.hh"
+#include "binaryio.hh"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/* Hospital tests
+ *
+ * Usage: test
+ * Runs logs of changes one by one, like READ_FROM does, and with REPLAY
+ * divided between shards, each into a hospital keeping history. Then
+ * checks that AS_OF prints the same reports on every date of the logs in
+ * both hospitals. Also checks that reports run in the background print the
+ * same as reports run right away, that a saved snapshot loads back and a
+ * corrupt one leaves the hospital as it was, and that dates convert to day
+ * numbers and back up to the last date that can be stored. Prints the
+ * failures and returns failure if there are any.
+*/
+
+// Number of shards of the replay, more than one so that the commands are
+// really divided.
+const unsigned int SHARDS = 4;
+
+// Size of the generated workload.
+const unsigned long PATIENTS = 2000;
+
+// Reports are started after every this many changes when comparing
+// background reports.
+const unsigned long REPORT_INTERVAL = 500;
+
+// Snapshot file written and removed by the test.
+const std::string SNAPSHOT_FILE = "test_snapshot.bin";
+
+// Position of the contents in a snapshot, after the magic, the version and
+// the checksum, which is the 8 bytes before it.
+const std::size_t SNAPSHOT_CONTENTS = 8 + 4 + 8;
+
+// A log of changes and its commands split into names and parameters.
+struct Log
+{
+    std::vector<std::string> lines;
+    std::vector<Cmd*> funcs;
+    std::vector<std::vector<std::string_view>> params;
+};
+
+// Splits the lines of the log, which must all be change commands.
+static void parse_log(Cli& cli, Log& log)
+{
+    std::string_view cmd;
+    for ( std::string& line : log.lines )
+    {
+        char* cursor = &line[0];
+        utils::next_token(cursor, cursor + line.size(), ' ', cmd);
+        log.params.emplace_back();
+        utils::split(cursor, &line[0] + line.size(), ' ', log.params.back());
+        log.funcs.push_back(cli.find_command(cmd));
+    }
+}
+
+// Returns the date of the given day number in the format ddmmyyyy.
+static std::string date_param(unsigned int day_number)
+{
+    Date date;
+    date.set_day_number(day_number);
+    std::string printed;
+    ReportWriter out;
+    out.set_string(&printed);
+    date.print(out);
+    out.flush();
+    std::vector<std::string> parts = utils::split(printed, '.');
+    std::string param;
+    for ( std::string& part : parts )
+    {
+        if ( part.size() < 2 )
+        {
+            part.insert(0, "0");
+        }
+        param += part;
+    }
+    return param;
+}
+
+// Returns the date printed (d.m.yyyy).
+static std::string printed(const Date& date)
+{
+    std::string text;
+    ReportWriter out;
+    out.set_string(&text);
+    date.print(out);
+    out.flush();
+    return text;
+}
+
+// Returns the day, month and year of the date.
+static std::vector<unsigned int> parts_of(const Date& date)
+{
+    std::string text = printed(date);
+    std::vector<unsigned int> parts;
+    for ( const std::string& part : utils::split(text, '.') )
+    {
+        parts.push_back(std::stoul(part));
+    }
+    return parts;
+}
+
+// Checks that dates set from their day, month and year get the same day
+// number back, around the year 0, today and the last date that can be
+// stored, and that dates can't go past the last one (18.1.11759221). Returns the number of
+// failures.
+static unsigned int check_dates()
+{
+    unsigned int failures = 0;
+    const unsigned int last = std::numeric_limits<unsigned int>::max();
+    for ( unsigned int first : {1u, 738000u, last - 1000} )
+    {
+        for ( unsigned int day_number = first;
+              day_number - first <= 1000; ++day_number )
+        {
+            Date date;
+            date.set_day_number(day_number);
+            std::vector<unsigned int> parts = parts_of(date);
+            // Like the original Date, set turns 29.2. into 1.2.
+            if ( parts.at(0) == 29 and parts.at(1) == 2 )
+            {
+                continue;
+            }
+            Date again;
+            if ( not again.set(parts.at(0), parts.at(1), parts.at(2)) or
+                 again.get_day_number() != day_number )
+            {
+                std::cout << "FAIL dates: round trip of " << day_number
+                          << std::endl;
+                ++failures;
+            }
+        }
+    }
+
+    Date today(24, 2, 2021);
+    if ( not today.advance(2147483647) or printed(today) != "4.9.5881631" )
+    {
+        std::cout << "FAIL dates: advance far" << std::endl;
+        ++failures;
+    }
+    // Failing changes leave the date as it was.
+    Date latest;
+    latest.set_day_number(last);
+    std::vector<unsigned int> parts = parts_of(latest);
+    Date date(1, 1, 2021);
+    bool is_valid = not latest.advance(1) and
+                    latest.get_day_number() == last and
+                    not date.advance(last) and printed(date) == "1.1.2021";
+    is_valid = not date.set(parts.at(0) + 1, parts.at(1), parts.at(2)) and
+               date.set(1, 1, 6000000) and printed(date) == "1.1.6000000" and
+               not date.set(1, 1, last) and
+               printed(date) == "1.1.6000000" and is_valid;
+    if ( not is_valid )
+    {
+        std::cout << "FAIL dates: limits" << std::endl;
+        ++failures;
+    }
+    return failures;
+}
+
+// Returns the output of a report run with AS_OF on the given date.
+static std::string as_of(Hospital& hospital, const std::string& date,
+                         Report report, Params params)
+{
+    std::string text;
+    hospital.output().set_string(&text);
+    hospital.print_as_of(date, report, params);
+    hospital.output().flush();
+    hospital.output().set_string(nullptr);
+    return text;
+}
+
+// Runs the log serially and with a replay, and compares reports of every
+// day from the first to the last date of the log. Returns the number of
+// differences.
+static unsigned int compare_as_of(const std::string& name, Log& log)
+{
+    Hospital serial;
+    EventLog serial_history;
+    serial.set_history(&serial_history);
+    serial.output().set_discard(true);
+    Cli cli(&serial, "");
+    parse_log(cli, log);
+    unsigned int first_day = 0;
+    for ( unsigned long i = 0; i < log.funcs.size(); ++i )
+    {
+        (serial.*(log.funcs.at(i)->func_ptr))(log.params.at(i));
+        if ( i == 0 )
+        {
+            first_day = serial.day_number();
+        }
+    }
+    serial.output().set_discard(false);
+
+    Hospital replayed;
+    EventLog replayed_history;
+    replayed.set_history(&replayed_history);
+    replayed.output().set_discard(true);
+    ParallelReplay replay(SHARDS);
+    for ( unsigned long i = 0; i < log.funcs.size(); ++i )
+    {
+        replay.add(log.funcs.at(i)->func_ptr, log.params.at(i));
+    }
+    unsigned long errors = 0;
+    if ( not replay.run(replayed, errors) )
+    {
+        std::cout << "FAIL " << name << ": merge shards" << std::endl;
+        return 1;
+    }
+    replayed.output().set_discard(false);
+
+    std::vector<std::pair<std::string, Report>> reports = {
+        {"print_current_patients", &Hospital::print_current_patients},
+        {"print_all_patients", &Hospital::print_all_patients},
+        {"print_all_medicines", &Hospital::print_all_medicines},
+        {"summary", &Hospital::print_summary}};
+    std::vector<std::string_view> params = {"10"};
+    unsigned int failures = 0;
+    for ( unsigned int day = first_day; day <= serial.day_number(); ++day )
+    {
+        std::string date = date_param(day);
+        for ( const std::pair<std::string, Report>& report : reports )
+        {
+            if ( as_of(serial, date, report.second, params) !=
+                 as_of(replayed, date, report.second, params) )
+            {
+                std::cout << "FAIL " << name << ": as_of " << date << " "
+                          << report.first << std::endl;
+                ++failures;
+            }
+        }
+    }
+    return failures;
+}
+
+// Runs the first half of the log one by one and the rest with a replay,
+// which merges shards into the hospital, and then one more change. Reports
+// started in between are run both right away and in the background.
+// Returns 1 if the outputs differ.
+static unsigned int compare_background(const std::string& name, Log& log)
+{
+    Hospital hospital;
+    Cli cli(&hospital, "");
+    parse_log(cli, log);
+    ReportRunner runner;
+    std::string foreground;
+    std::vector<std::string_view> params = {"10"};
+    unsigned long half = log.funcs.size() / 2;
+    for ( unsigned long i = 0; i <= half; ++i )
+    {
+        if ( i % REPORT_INTERVAL == 0 or i == half )
+        {
+            Report report = i % (2 * REPORT_INTERVAL) == 0 ?
+                        &Hospital::print_current_patients :
+                        &Hospital::print_summary;
+            hospital.output().set_string(&foreground);
+            (hospital.*report)(params);
+            hospital.output().flush();
+            hospital.output().set_string(nullptr);
+            runner.start(hospital, report, params);
+        }
+        if ( i < half )
+        {
+            hospital.output().set_discard(true);
+            (hospital.*(log.funcs.at(i)->func_ptr))(log.params.at(i));
+            hospital.output().set_discard(false);
+        }
+    }
+
+    hospital.output().set_discard(true);
+    ParallelReplay replay(SHARDS);
+    for ( unsigned long i = half; i < log.funcs.size(); ++i )
+    {
+        replay.add(log.funcs.at(i)->func_ptr, log.params.at(i));
+    }
+    unsigned long errors = 0;
+    if ( not replay.run(hospital, errors) )
+    {
+        std::cout << "FAIL " << name << ": merge shards" << std::endl;
+        return 1;
+    }
+    // A change after the merge must not hide that the merge was not logged.
+    std::vector<std::string_view> late = {"late_patient"};
+    hospital.enter(late);
+    hospital.output().set_discard(false);
+    hospital.output().set_string(&foreground);
+    hospital.print_all_patients(params);
+    hospital.output().flush();
+    hospital.output().set_string(nullptr);
+    runner.start(hospital, &Hospital::print_all_patients, params);
+
+    std::string background;
+    ReportWriter out;
+    out.set_string(&background);
+    runner.write_all(out);
+    out.flush();
+    if ( background != foreground or foreground.empty() )
+    {
+        std::cout << "FAIL " << name << ": background reports" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// Returns the output of a report.
+static std::string report_of(Hospital& hospital, Report report)
+{
+    std::string text;
+    std::vector<std::string_view> params = {"10"};
+    hospital.output().set_string(&text);
+    (hospital.*report)(params);
+    hospital.output().flush();
+    hospital.output().set_string(nullptr);
+    return text;
+}
+
+// Returns the reports compared after loading a snapshot.
+static std::string reports_of(Hospital& hospital)
+{
+    return report_of(hospital, &Hospital::print_all_patients) +
+            report_of(hospital, &Hospital::print_all_medicines) +
+            report_of(hospital, &Hospital::print_summary);
+}
+
+// Saves the hospital of the log to a snapshot and loads it into another
+// hospital, which must then report the same. Loading a corrupt snapshot
+// must fail without changing the hospital. Returns the number of failures.
+static unsigned int check_snapshots(const std::string& name, Log& log)
+{
+    Hospital saved;
+    saved.output().set_discard(true);
+    Cli cli(&saved, "");
+    parse_log(cli, log);
+    for ( unsigned long i = 0; i < log.funcs.size(); ++i )
+    {
+        (saved.*(log.funcs.at(i)->func_ptr))(log.params.at(i));
+    }
+    saved.save_snapshot({SNAPSHOT_FILE});
+    saved.output().set_discard(false);
+
+    unsigned int failures = 0;
+    Hospital loaded;
+    loaded.output().set_discard(true);
+    loaded.load_snapshot({SNAPSHOT_FILE});
+    loaded.output().set_discard(false);
+    std::string expected = reports_of(saved);
+    if ( loaded.error_count() != 0 or reports_of(loaded) != expected )
+    {
+        std::cout << "FAIL " << name << ": load snapshot" << std::endl;
+        ++failures;
+    }
+
+    // One with a bad checksum and one that only fails after the contents
+    // have been read, as it has a byte too many.
+    std::string data;
+    utils::read_file(SNAPSHOT_FILE, data);
+    std::string bad_checksum = data.substr(0, data.size() - 1);
+    std::string extra_byte = data + '\0';
+    std::uint64_t checksum = binaryio::checksum(
+                extra_byte.data() + SNAPSHOT_CONTENTS,
+                extra_byte.data() + extra_byte.size());
+    for ( unsigned int i = 0; i < 8; ++i )
+    {
+        extra_byte.at(SNAPSHOT_CONTENTS - 8 + i) = char(checksum >> (8 * i));
+    }
+    for ( const std::string& corrupt : {bad_checksum, extra_byte} )
+    {
+        utils::write_file(SNAPSHOT_FILE, corrupt);
+        unsigned long version = loaded.version();
+        unsigned long errors = loaded.error_count();
+        loaded.output().set_discard(true);
+        loaded.load_snapshot({SNAPSHOT_FILE});
+        loaded.output().set_discard(false);
+        if ( loaded.error_count() != errors + 1 or
+             loaded.version() != version or reports_of(loaded) != expected )
+        {
+            std::cout << "FAIL " << name << ": load corrupt snapshot"
+                      << std::endl;
+            ++failures;
+        }
+    }
+    std::remove(SNAPSHOT_FILE.c_str());
+    return failures;
+}
+
+int main()
+{
+    unsigned int failures = check_dates();
+
+    Log dated;
+    dated.lines = {"set_date 1 1 2020", "enter alice", "advance_date 5",
+                   "enter bob", "advance_date 5", "enter carol"};
+    failures += compare_as_of("dated entries", dated);
+
+    Log workload;
+    workload.lines.push_back("set_date 1 1 2021");
+    benchmark::generate_workload(benchmark::default_settings(PATIENTS),
+                                 workload.lines);
+    failures += compare_as_of("workload", workload);
+
+    // Commands of a parsed log belong to the interpreter that parsed it.
+    Log background;
+    background.lines = workload.lines;
+    failures += compare_background("workload", background);
+
+    Log snapshot;
+    snapshot.lines = workload.lines;
+    failures += check_snapshots("workload", snapshot);
+
+    if ( failures != 0 )
+    {
+        return EXIT_FAILURE;
+    }
+    std::cout << "All tests passed." << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,34 @@
+TEMPLATE = app
+CONFIG += console c++17 thread
+CONFIG -= app_bundle
+CONFIG -= qt
+
+INCLUDEPATH += .. ../benchmark
+
+SOURCES += \
+        main.cpp \
+    ../benchmark/workload.cpp \
+    ../person.cpp \
+    ../date.cpp \
+    ../careperiod.cpp \
+    ../hospital.cpp \
+    ../cli.cpp \
+    ../utils.cpp \
+    ../symboltable.cpp \
+    ../reportwriter.cpp \
+    ../binaryio.cpp \
+    ../journal.cpp \
+    ../reportrunner.cpp \
+    ../intervalindex.cpp \
+    ../census.cpp \
+    ../latencyhistogram.cpp \
+    ../parallelreplay.cpp \
+    ../eventlog.cpp \
+    ../prescriptionlog.cpp \
+    ../tally.cpp
+
+HEADERS += \
+    ../benchmark/workload.hh \
+    ../objectpool.hh \
+    ../smallset.hh \
+    ../cli.hh
@@ -1,32 +1,69 @@
 #include "utils.hh"
+#include <cerrno>
+#include <fcntl.h>
+#include <fstream>
+#include <limits>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Bytes read from a file at a time.
+const std::size_t READ_CHUNK_SIZE = 1 << 16;
 
 std::vector<std::string> utils::split( std::string& str, char delim )
 {
-    std::vector<std::string> result = {""};
+    std::string characters = str;
+    std::vector<std::string_view> parts;
+    split(&characters[0], &characters[0] + characters.size(), delim, parts);
+    return std::vector<std::string>(parts.begin(), parts.end());
+}
+
+bool utils::next_token( char*& cursor, char* end, char delim,
+                        std::string_view& token )
+{
+    // Characters of the token are moved to the left over the quotes.
+    char* start = cursor;
+    char* copy = cursor;
     bool cont = false;
-    for ( auto cha : str )
+    for ( ; cursor != end; ++cursor )
     {
-        if ( cha == '"' )
+        if ( *cursor == '"' )
         {
             cont = not cont;
         }
-        else if ( cha == delim and not cont)
+        else if ( *cursor == delim and not cont )
         {
-            result.push_back("");
+            token = std::string_view(start, copy - start);
+            ++cursor;
+            return true;
         }
         else
         {
-            result.back().push_back(cha);
+            *copy = *cursor;
+            ++copy;
         }
     }
-    if ( result.back() == "" )
+    token = std::string_view(start, copy - start);
+    return false;
+}
+
+void utils::split( char* begin, char* end, char delim,
+                   std::vector<std::string_view>& result )
+{
+    result.clear();
+    std::string_view token;
+    bool more = true;
+    while ( more )
     {
-        result.erase(--result.end());
+        more = next_token(begin, end, delim, token);
+        result.push_back(token);
+    }
+    if ( result.back().empty() )
+    {
+        result.pop_back();
     }
-    return result;
 }
 
-bool utils::is_numeric(std::string s, bool zero_allowed)
+bool utils::is_numeric(std::string_view s, bool zero_allowed)
 {
     if( not zero_allowed )
     {
@@ -43,12 +80,109 @@ bool utils::is_numeric(std::string s, bool zero_allowed)
             return false;
         }
     }
+    unsigned int number = 0;
     for( unsigned int i = 0; i < s.length(); ++i )
     {
         if( not isdigit(s.at(i)) )
         {
             return false;
         }
+        // The number must fit, so that to_number doesn't wrap around.
+        unsigned int digit = s.at(i) - '0';
+        if( number > (std::numeric_limits<unsigned int>::max() - digit) / 10 )
+        {
+            return false;
+        }
+        number = number * 10 + digit;
+    }
+    return true;
+}
+
+unsigned int utils::to_number(std::string_view s)
+{
+    unsigned int number = 0;
+    for ( char cha : s )
+    {
+        number = number * 10 + (cha - '0');
+    }
+    return number;
+}
+
+bool utils::read_file(const std::string& filename, std::string& contents)
+{
+    // Directories can be opened but not read. The size of a regular file is
+    // only a hint, pipes have none, so the file is read until its end.
+    struct stat status;
+    if( ::stat(filename.c_str(), &status) != 0 or S_ISDIR(status.st_mode) )
+    {
+        return false;
+    }
+    std::ifstream file(filename, std::ios::binary);
+    if( not file )
+    {
+        return false;
+    }
+    contents.clear();
+    if( S_ISREG(status.st_mode) )
+    {
+        contents.reserve(status.st_size);
+    }
+    char chunk[READ_CHUNK_SIZE];
+    while( file.read(chunk, READ_CHUNK_SIZE) or file.gcount() > 0 )
+    {
+        contents.append(chunk, file.gcount());
+    }
+    return not file.bad();
+}
+
+bool utils::write_file(const std::string& filename,
+                       const std::string& contents)
+{
+    std::string temporary = filename + ".tmp";
+    int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if( fd < 0 )
+    {
+        return false;
+    }
+    bool is_written = write_all(fd, contents) and ::fsync(fd) == 0;
+    if( ::close(fd) != 0 or not is_written or
+        ::rename(temporary.c_str(), filename.c_str()) != 0 )
+    {
+        ::unlink(temporary.c_str());
+        return false;
+    }
+
+    // The rename itself is durable only when the directory is synced.
+    std::string::size_type slash = filename.rfind('/');
+    std::string directory = slash == std::string::npos ?
+                "." : filename.substr(0, slash + 1);
+    int directory_fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if( directory_fd < 0 )
+    {
+        return false;
+    }
+    bool is_synced = ::fsync(directory_fd) == 0;
+    ::close(directory_fd);
+    return is_synced;
+}
+
+bool utils::write_all(int fd, const std::string& data)
+{
+    const char* current = data.data();
+    std::size_t left = data.size();
+    while( left > 0 )
+    {
+        ssize_t written = ::write(fd, current, left);
+        if( written < 0 )
+        {
+            if( errno == EINTR )
+            {
+                continue;
+            }
+            return false;
+        }
+        current += written;
+        left -= written;
     }
     return true;
 }
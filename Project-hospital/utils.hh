@@ -12,6 +12,7 @@
 #include "date.hh"
 #include <vector>
 #include <string>
+#include <string_view>
 
 namespace utils
 {
@@ -24,17 +25,82 @@ namespace utils
  */
 std::vector<std::string> split( std::string& str, char delim = ';');
 
+/**
+ * @brief next_token
+ * @param cursor start of the characters, moved past the token and the
+ * delim char ending it
+ * @param end end of the characters
+ * @param delim
+ * @param token the token found, no delim or double quote chars
+ * @return true if the token ended with a delim char, i.e. another token
+ * follows it
+ * Double quotes are removed by moving the rest of the token over them, so
+ * the characters are modified and the token points into them.
+ */
+bool next_token( char*& cursor, char* end, char delim,
+                 std::string_view& token );
+
+/**
+ * @brief split
+ * @param begin start of the characters to split
+ * @param end end of the characters to split
+ * @param delim
+ * @param result vector to store the parts into
+ * Splits the given characters like the function above, but the parts point
+ * into the characters instead of being copies of them. The characters are
+ * modified like in next_token, and the parts are valid as long as they are.
+ */
+void split( char* begin, char* end, char delim,
+            std::vector<std::string_view>& result );
+
 /**
  * @brief is_numeric
  * @param s
  * @param zero_allowed : if zero is allowed to be the whole string
  * @return true if given string is numeric
+ * A number too large for an unsigned int is not numeric.
+ */
+bool is_numeric(std::string_view s, bool zero_allowed);
+
+/**
+ * @brief to_number
+ * @param s numeric string, see is_numeric
+ * @return value of the given numeric string
+ */
+unsigned int to_number(std::string_view s);
+
+/**
+ * @brief read_file
+ * @param filename
+ * @param contents the whole contents of the file
+ * @return false if the file could not be read
+ */
+bool read_file(const std::string& filename, std::string& contents);
+
+/**
+ * @brief write_file
+ * @param filename
+ * @param contents
+ * @return false if the file could not be written
+ * Replaces the file with the given contents. The contents are written to a
+ * temporary file, synced to disk and renamed over the file, so after a
+ * crash the file has either its old or its new contents.
+ */
+bool write_file(const std::string& filename, const std::string& contents);
+
+/**
+ * @brief write_all
+ * @param fd file descriptor open for writing
+ * @param data
+ * @return false if the data could not be written
+ * Writes all given bytes, retrying interrupted and partial writes.
  */
-bool is_numeric(std::string s, bool zero_allowed);
+bool write_all(int fd, const std::string& data);
 
 /**
  * @brief today
- * Static means this variable will only be created once per run.
+ * Date a new hospital starts from, each hospital keeps its own current
+ * date.
  */
 static Date today = Date(24, 2, 2021);
 }